@@ -0,0 +1,45 @@
+#!/usr/bin/env bash
+# Compares the face selection solvers on the models in data/*.off.
+#
+# Usage: scripts/benchmark_solvers.sh <path/to/MeshPolygonization> [solver ...]
+#        (default solvers: gurobi highs)
+#
+# For each model and solver, prints the time of the simplification stage (which includes
+# the optimization), the objective of the complete program and the number of faces of the result. The results are written to a copy of each
+# model in a temporary directory, data/ is left untouched.
+
+set -euo pipefail
+
+if [ $# -lt 1 ]; then
+    echo "Usage: $0 <path/to/MeshPolygonization> [solver ...]"
+    exit 1
+fi
+
+binary="$1"
+shift
+solvers=("$@")
+if [ ${#solvers[@]} -eq 0 ]; then
+    solvers=(gurobi highs)
+fi
+
+root="$(cd "$(dirname "$0")/.." && pwd)"
+work="$(mktemp -d)"
+trap 'rm -rf "$work"' EXIT
+
+printf "%-12s %-14s %12s %16s %8s\n" "model" "solver" "secs" "objective" "faces"
+for model in "$root"/data/*.off; do
+    name="$(basename "$model" .off)"
+    for solver in "${solvers[@]}"; do
+        cp "$model" "$work/$name.off"
+        log="$work/$name-$solver.log"
+        if ! "$binary" "$work/$name.off" --solver "$solver" > "$log" 2>&1; then
+            printf "%-12s %-14s %12s\n" "$name" "$solver" "failed"
+            continue
+        fi
+
+        secs="$(grep -m1 '^Simplification:' "$log" | awk '{print $2}')"
+        objective="$(grep -m1 '^Objective:' "$log" | awk '{print $2}')"
+        faces="$(grep -m1 '^element face' "$work/$name.off-result.ply" | awk '{print $3}')"
+        printf "%-12s %-14s %12s %16s %8s\n" "$name" "$solver" "${secs:--}" "${objective:--}" "${faces:--}"
+    done
+done
@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+# Sends meshes to a running polygonization service (MeshPolygonization --serve <socket>).
+#
+# Usage: scripts/polygonize_client.py <socket> <model.off|model.ply> [result] [key value ...]
+#        e.g. scripts/polygonize_client.py /tmp/MeshPolygonization.sock data/arc.off arc.ply distance 0.8 solver highs
+#
+# The mesh content is sent over the socket, the stage metrics are printed as they arrive and the
+# result is written to the given file (default: <model>-result.<format>).
+
+import os
+import socket
+import sys
+
+
+def read_line(stream):
+    line = stream.readline()
+    if not line:
+        raise ConnectionError("connection closed by the service")
+    return line.decode().rstrip("\r\n")
+
+
+def polygonize(socket_path, model, result=None, **params):
+    with open(model, "rb") as f:
+        content = f.read()
+    mesh_format = os.path.splitext(model)[1][1:].lower()
+
+    request = ["polygonize"] + ["%s %s" % (key, value) for key, value in params.items()]
+    request.append("mesh %s %d" % (mesh_format, len(content)))
+
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as conn:
+        conn.connect(socket_path)
+        conn.sendall(("\n".join(request) + "\n").encode() + content + b"end\n")
+        stream = conn.makefile("rb")
+        while True:
+            line = read_line(stream)
+            print(line)
+            words = line.split()
+            if words[0] == "result" and words[1] != "file":
+                data = stream.read(int(words[2]))
+                extension = ".obj" if words[1] == "obj" else ".ply"
+                result = result or model + "-result" + extension
+                with open(result, "wb") as f:
+                    f.write(data)
+                print("Result saved to file '%s'" % result)
+            elif words[0] in ("done", "error", "busy"):
+                return words[0] == "done"
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 3:
+        print("Usage: %s <socket> <model.off|model.ply> [result] [key value ...]" % sys.argv[0])
+        sys.exit(1)
+    args = sys.argv[3:]
+    result = args.pop(0) if len(args) % 2 == 1 else None
+    params = dict(zip(args[0::2], args[1::2]))
+    sys.exit(0 if polygonize(sys.argv[1], sys.argv[2], result, **params) else 1)
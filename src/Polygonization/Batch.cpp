@@ -0,0 +1,423 @@
+/**
+ * MeshPolygonization is the implementation of the MVS (Multi-view Stereo) building mesh simplification method
+ * described in the following paper:
+ *      Vasileios Bouzas, Hugo Ledoux, and  Liangliang Nan.
+ *      Structure-aware Building Mesh Polygonization.
+ *      ISPRS Journal of Photogrammetry and Remote Sensing. 167(2020), 432-442, 2020.
+ * Please cite the above paper if you use the code/program (or part of it).
+ *
+ * LICENSE:
+ *      MeshPolygonization is free for academic use. If you are interested in a commercial license please contact
+ *      the 3D Geoinformation group.
+ *
+ * Copyright (C) 2019 3D Geoinformation Research Group
+ * https://3d.bk.tudelft.nl/
+ */
+
+#include "Batch.h"
+#include "FileReader.h"
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <numeric>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <filesystem>
+#include <condition_variable>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+namespace fs = std::filesystem;
+
+
+namespace {
+
+	typedef std::chrono::steady_clock Clock;
+
+	double seconds_since(Clock::time_point t0) {
+		return std::chrono::duration<double>(Clock::now() - t0).count();
+	}
+
+	// Threads of the parallel regions started by the calling thread
+	void set_num_threads(std::size_t num_threads) {
+#ifdef _OPENMP
+		omp_set_num_threads(int(num_threads));
+#endif
+	}
+
+
+	// Input mesh, and not a result of a previous run (-result, -sweep) or exported candidates
+	bool is_mesh_file(const fs::path& path) {
+		std::string extension = path.extension().string();
+		for (auto& c : extension) { c = char(std::tolower(c)); }
+		if (extension != ".off" && extension != ".ply") { return false; }
+
+		std::string stem = path.stem().string();
+		return stem.find("-result") == std::string::npos && stem.find("-sweep") == std::string::npos
+			   && stem.find("-candidates") == std::string::npos;
+	}
+
+
+	std::string csv_field(const std::string& text) {
+		if (text.find_first_of(",\"\r\n") == std::string::npos) { return text; }
+		std::string quoted = "\"";
+		for (char c : text) {
+			if (c == '"') { quoted += '"'; }
+			quoted += c;
+		}
+		return quoted + "\"";
+	}
+
+
+	// Work-stealing task queues, one per worker
+	// The owner takes the tasks from the front of its queue, thieves from the back of the longest queue.
+	// All tasks are pushed before the workers start, so a worker is done when no queue has any left.
+	class Work_queues {
+	public:
+		explicit Work_queues(std::size_t num_workers) : queues_(num_workers) {}
+
+		void push(std::size_t worker, std::size_t task) {
+			std::lock_guard<std::mutex> lock(queues_[worker].mutex);
+			queues_[worker].tasks.push_back(task);
+		}
+
+		bool pop(std::size_t worker, std::size_t* task) {
+			Queue& queue = queues_[worker];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (queue.tasks.empty()) { return false; }
+			*task = queue.tasks.front();
+			queue.tasks.pop_front();
+			return true;
+		}
+
+		bool steal(std::size_t thief, std::size_t* task) {
+			for (;;) {
+				std::size_t victim = thief, longest = 0;
+				for (std::size_t i = 0; i < queues_.size(); i++) {
+					if (i == thief) { continue; }
+					std::lock_guard<std::mutex> lock(queues_[i].mutex);
+					if (queues_[i].tasks.size() > longest) {
+						longest = queues_[i].tasks.size();
+						victim = i;
+					}
+				}
+				if (longest == 0) { return false; }
+
+				// The victim may have emptied its queue meanwhile, look again
+				Queue& queue = queues_[victim];
+				std::lock_guard<std::mutex> lock(queue.mutex);
+				if (queue.tasks.empty()) { continue; }
+				*task = queue.tasks.back();
+				queue.tasks.pop_back();
+				return true;
+			}
+		}
+
+	private:
+		struct Queue {
+			std::mutex mutex;
+			std::deque<std::size_t> tasks;
+		};
+		std::vector<Queue> queues_;
+	};
+
+
+	// Cores shared by the workers, granted in the order of the requests (so that a large request is
+	// not starved by small ones). Cores are never held while waiting for more, hence no deadlock.
+	class Core_budget {
+	public:
+		explicit Core_budget(std::size_t num_cores) : num_free_(num_cores), next_(0), serving_(0) {}
+
+		// One core for a short phase (reading a mesh), granted as soon as one is free, ahead of the
+		// queued requests. A worker reads once before it queues again, so the queue is only delayed
+		// by the reads already started.
+		void acquire_one() {
+			std::unique_lock<std::mutex> lock(mutex_);
+			changed_.wait(lock, [&] { return num_free_ >= 1; });
+			num_free_--;
+		}
+
+		// num must not exceed the number of cores
+		void acquire(std::size_t num) {
+			std::unique_lock<std::mutex> lock(mutex_);
+			std::size_t ticket = next_++;
+			changed_.wait(lock, [&] { return serving_ == ticket && num_free_ >= num; });
+			num_free_ -= num;
+			serving_++;
+			lock.unlock();
+			changed_.notify_all();
+		}
+
+		void release(std::size_t num) {
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				num_free_ += num;
+			}
+			changed_.notify_all();
+		}
+
+	private:
+		std::size_t num_free_;
+		std::size_t next_;
+		std::size_t serving_;
+		std::mutex mutex_;
+		std::condition_variable changed_;
+	};
+
+}
+
+
+Batch::Batch(const PolygonizerConfig& config, const Batch_parameters& params)
+	: config_(config)
+	, params_(params)
+{
+	config_.verbose = false;
+	config_.program_export.clear();
+	config_.optimization.report_file.clear();
+	num_threads_ = (params_.num_threads > 0) ? params_.num_threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+
+Batch::~Batch()
+{
+}
+
+
+std::vector<std::string> Batch::collect_files(const std::string& path) {
+	std::vector<std::string> files;
+	std::error_code error;
+
+	// Directory
+	if (fs::is_directory(path, error)) {
+		fs::recursive_directory_iterator it(path, fs::directory_options::skip_permission_denied, error), end;
+		for (; !error && it != end; it.increment(error)) {
+			if (it->is_regular_file(error) && is_mesh_file(it->path())) { files.push_back(it->path().string()); }
+		}
+		std::sort(files.begin(), files.end());
+		return files;
+	}
+
+	// Manifest
+	std::ifstream input(path.c_str());
+	if (input.fail()) {
+		std::cerr << "Failed to open file \'" << path << "\'" << std::endl;
+		return files;
+	}
+	fs::path base = fs::path(path).parent_path();
+	std::string line;
+	while (std::getline(input, line)) {
+		std::size_t first = line.find_first_not_of(" \t\r");
+		if (first == std::string::npos || line[first] == '#') { continue; }
+		std::size_t last = line.find_last_not_of(" \t\r");
+		fs::path file(line.substr(first, last - first + 1));
+		if (file.is_relative()) { file = base / file; }
+		files.push_back(file.string());
+	}
+	return files;
+}
+
+
+std::vector<Batch_record> Batch::run(const std::vector<std::string>& files) {
+	std::vector<Batch_record> records(files.size());
+	for (std::size_t i = 0; i < files.size(); i++) { records[i].file = files[i]; }
+	if (files.empty()) { return records; }
+
+	// Results keep their path relative to the deepest directory holding all the meshes,
+	// so that meshes with the same name in different directories do not overwrite each other
+	input_root_.clear();
+	if (!params_.output_directory.empty()) {
+		for (std::size_t i = 0; i < files.size(); i++) {
+			std::error_code error;
+			fs::path directory = fs::absolute(files[i], error).lexically_normal().parent_path();
+			if (i == 0) {
+				input_root_ = directory.string();
+				continue;
+			}
+			fs::path common;
+			fs::path root(input_root_);
+			for (auto a = root.begin(), b = directory.begin(); a != root.end() && b != directory.end() && *a == *b; ++a, ++b) {
+				common /= *a;
+			}
+			input_root_ = common.string();
+		}
+	}
+
+	// Largest buildings first (by file size), so that they do not end up alone at the end
+	std::vector<std::uintmax_t> sizes(files.size(), 0);
+	for (std::size_t i = 0; i < files.size(); i++) {
+		std::error_code error;
+		sizes[i] = fs::file_size(files[i], error);
+		if (error) { sizes[i] = 0; }
+	}
+	std::vector<std::size_t> order(files.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return sizes[a] > sizes[b]; });
+
+	// Dealt round-robin, each queue is ordered largest first as well
+	std::size_t num_workers = std::min(num_threads_, files.size());
+	Work_queues queues(num_workers);
+	for (std::size_t k = 0; k < order.size(); k++) {
+		queues.push(k % num_workers, order[k]);
+	}
+
+	Core_budget cores(num_threads_);
+	std::atomic<std::size_t> num_done(0);
+	std::mutex log_mutex;
+
+	auto worker = [&](std::size_t w) {
+		std::size_t task = 0;
+		while (queues.pop(w, &task) || queues.steal(w, &task)) {
+			Batch_record& record = records[task];
+			Clock::time_point t0 = Clock::now();
+
+			// Read on one core, then polygonize on as many as the building calls for
+			Mesh mesh;
+			cores.acquire_one();
+			set_num_threads(1);
+			bool success = read(files[task], &mesh, &record);
+			cores.release(1);
+			if (success) {
+				std::size_t num_threads = threads_for(record.num_input_faces);
+				cores.acquire(num_threads);
+				set_num_threads(num_threads);
+				polygonize(&mesh, num_threads, &record);
+				cores.release(num_threads);
+			}
+			record.total_time = seconds_since(t0);
+
+			std::ostringstream log;
+			log << "[" << ++num_done << "/" << files.size() << "] " << record.file << ": ";
+			if (record.success) { log << record.stats.num_faces << " faces, "; }
+			else { log << "failed (" << record.error << "), "; }
+			log << std::fixed << std::setprecision(2) << record.total_time << " secs, " << record.num_threads << " thread(s)";
+			std::lock_guard<std::mutex> lock(log_mutex);
+			std::cout << log.str() << std::endl;
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (std::size_t w = 0; w < num_workers; w++) {
+		workers.emplace_back(worker, w);
+	}
+	for (auto& thread : workers) { thread.join(); }
+
+	return records;
+}
+
+
+bool Batch::read(const std::string& file, Mesh* mesh, Batch_record* record) const {
+	Clock::time_point t0 = Clock::now();
+	try {
+		if (!readMesh(file, mesh)) {
+			record->error = "failed to read mesh";
+			return false;
+		}
+	}
+	catch (const std::exception& e) {
+		record->error = e.what();
+		return false;
+	}
+	record->num_input_faces = mesh->number_of_faces();
+	record->read_time = seconds_since(t0);
+	return true;
+}
+
+
+void Batch::polygonize(Mesh* mesh, std::size_t num_threads, Batch_record* record) const {
+	PolygonizerConfig config = config_;
+	int& solver_threads = config.optimization.budget.num_threads;
+	if (solver_threads <= 0 || solver_threads > int(num_threads)) {
+		solver_threads = int(num_threads);
+	}
+	record->num_threads = num_threads;
+
+	try {
+		Polygonizer polygonizer(config);
+		PolygonizerResult result = polygonizer.apply(mesh);
+		record->stats = result.stats;
+		if (!result.success) {
+			record->error = "no polygonal surface was obtained";
+			return;
+		}
+
+		std::string file = result_file(record->file);
+		if (!params_.output_directory.empty()) {
+			std::error_code error;
+			fs::create_directories(fs::path(file).parent_path(), error);
+		}
+		if (!writeSimplified(&result.mesh, file, params_.format)) {
+			record->error = "failed to write \'" + file + "\'";
+			return;
+		}
+		record->result_file = file;
+		record->success = true;
+	}
+	catch (const std::exception& e) {
+		record->error = e.what();
+	}
+	catch (...) {
+		record->error = "unknown exception";
+	}
+}
+
+
+std::size_t Batch::threads_for(std::size_t num_faces) const {
+	std::size_t faces_per_thread = std::max<std::size_t>(params_.faces_per_thread, 1);
+	std::size_t num_threads = std::max<std::size_t>((num_faces + faces_per_thread - 1) / faces_per_thread, 1);
+	if (params_.max_threads_per_building > 0) {
+		num_threads = std::min(num_threads, params_.max_threads_per_building);
+	}
+	return std::min(num_threads, num_threads_);
+}
+
+
+std::string Batch::result_file(const std::string& file) const {
+	std::string name = file + "-result" + output_extension(params_.format);
+	if (params_.output_directory.empty()) { return name; }
+	std::error_code error;
+	fs::path relative = fs::absolute(name, error).lexically_normal().lexically_relative(input_root_);
+	if (relative.empty()) { relative = fs::path(name).filename(); }
+	return (fs::path(params_.output_directory) / relative).string();
+}
+
+
+bool Batch::report(const std::vector<Batch_record>* records, const std::string& file) {
+	std::size_t num_failed = 0;
+	double total_time = 0.0;
+	for (auto& record : *records) {
+		if (!record.success) { num_failed++; }
+		total_time += record.total_time;
+	}
+	std::cout << "----------------------------------------------------------------" << std::endl;
+	std::cout << "Batch: " << records->size() << " buildings, " << records->size() - num_failed << " done, " << num_failed << " failed ("
+		      << std::fixed << std::setprecision(1) << total_time << " building secs)" << std::defaultfloat << std::endl;
+
+	if (file.empty()) { return true; }
+
+	std::ofstream output(file.c_str());
+	if (output.fail()) {
+		std::cerr << "Failed to create file \'" << file << "\'" << std::endl;
+		return false;
+	}
+	output << "file,result_file,success,error,input_faces,threads,segments,planes,candidates,faces,"
+		   << "read_time,planarity_time,segmentation_time,graph_time,scaffold_time,selection_time,total_time" << std::endl;
+	for (auto& record : *records) {
+		const PolygonizerStats& stats = record.stats;
+		output << csv_field(record.file) << "," << csv_field(record.result_file) << "," << (record.success ? 1 : 0) << ","
+			   << csv_field(record.error) << "," << record.num_input_faces << "," << record.num_threads << ","
+			   << stats.num_segments << "," << stats.num_planes << "," << stats.num_candidates << "," << stats.num_faces << ","
+			   << record.read_time << "," << stats.planarity_time << "," << stats.segmentation_time << "," << stats.graph_time << ","
+			   << stats.scaffold_time << "," << stats.selection_time << "," << record.total_time << std::endl;
+	}
+	std::cout << "Batch records saved to file \'" << file << "\'" << std::endl;
+	return true;
+}
@@ -0,0 +1,101 @@
+/**
+ * MeshPolygonization is the implementation of the MVS (Multi-view Stereo) building mesh simplification method
+ * described in the following paper:
+ *      Vasileios Bouzas, Hugo Ledoux, and  Liangliang Nan.
+ *      Structure-aware Building Mesh Polygonization.
+ *      ISPRS Journal of Photogrammetry and Remote Sensing. 167(2020), 432-442, 2020.
+ * Please cite the above paper if you use the code/program (or part of it).
+ *
+ * LICENSE:
+ *      MeshPolygonization is free for academic use. If you are interested in a commercial license please contact
+ *      the 3D Geoinformation group.
+ *
+ * Copyright (C) 2019 3D Geoinformation Research Group
+ * https://3d.bk.tudelft.nl/
+ */
+
+#pragma once
+
+#include "Polygonizer.h"
+#include "FileWritter.h"
+
+
+// BATCH PARAMETERS //
+struct Batch_parameters {
+	// Number of cores shared by all the buildings (0 for all cores)
+	std::size_t num_threads = 0;
+
+	// Threads of a building: one per faces_per_thread input faces, up to max_threads_per_building (0 for no limit)
+	std::size_t faces_per_thread = 20000;
+	std::size_t max_threads_per_building = 0;
+
+	// Directory of the results (empty to write them next to the inputs), named <input file>-result.<format>
+	// and placed at the same path relative to the deepest directory holding all the inputs
+	std::string output_directory;
+
+	// Format of the results
+	Output_parameters::Format format = Output_parameters::PLY_ASCII;
+};
+// BATCH PARAMETERS //
+
+
+// BATCH RECORD //
+// Result or failure of one building
+struct Batch_record {
+	std::string file;
+	std::string result_file;
+	bool success = false;
+	std::string error;
+
+	std::size_t num_input_faces = 0;
+	std::size_t num_threads = 0;
+	PolygonizerStats stats;
+
+	// Times (secs)
+	double read_time = 0.0;
+	double total_time = 0.0;
+};
+// BATCH RECORD //
+
+
+// Batch polygonization of many buildings
+// Buildings are scheduled on a work-stealing pool, largest first: each worker takes the buildings of
+// its own queue and, when it runs out, steals from the longest queue of the others. The cores are a
+// shared budget, a building gets as many as its size calls for (see Batch_parameters), so that big
+// buildings run their stages in parallel and small ones run side by side on one core each.
+// Failures are recorded per building and do not stop the batch.
+class Batch
+{
+public:
+	// Buildings are polygonized with config (the program export and the solver telemetry file are ignored)
+	Batch(const PolygonizerConfig& config, const Batch_parameters& params);
+	~Batch();
+
+	// Meshes (.off, .ply) of a directory (recursively, skipping the results of previous runs), or listed
+	// in a manifest file (one path per line, relative to the manifest, '#' for comments)
+	static std::vector<std::string> collect_files(const std::string& path);
+
+	// Records are in the order of files
+	std::vector<Batch_record> run(const std::vector<std::string>& files);
+
+	// Write one CSV row per building, with its metrics or failure
+	static bool report(const std::vector<Batch_record>* records, const std::string& file);
+
+private:
+	// Stages of a building, the worker thread runs them with num_threads
+	bool read(const std::string& file, Mesh* mesh, Batch_record* record) const;
+	void polygonize(Mesh* mesh, std::size_t num_threads, Batch_record* record) const;
+
+	// Threads of a building with num_faces input faces
+	std::size_t threads_for(std::size_t num_faces) const;
+
+	std::string result_file(const std::string& file) const;
+
+private:
+	PolygonizerConfig config_;
+	Batch_parameters params_;
+	std::size_t num_threads_;
+
+	// Deepest directory holding all the inputs of the current run (output_directory only)
+	std::string input_root_;
+};
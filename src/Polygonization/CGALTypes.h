@@ -133,9 +133,6 @@ struct Plane_intersection {
 	// Faces
 	std::vector<int> faces;
 
-	// Adjacency fan
-	std::vector<Face> fan;
-
 	// Supporting planes
 	std::set<int> planes;
 };
@@ -162,6 +159,9 @@ struct Candidate_face {
 	// Total area
 	double area;
 
+	// Distance to supporting data
+	double data_distance;
+
 	// Supporting plane
 	int plane;
 };
@@ -215,6 +215,44 @@ inline std::pair<std::size_t, double> compute_confidence(Polygon_2* polygon, std
 }
 
 
+// Compute distance to data
+inline double compute_data_distance(Polygon_2* polygon, std::vector<Polygon_2>* faces) {
+	double min_dist = std::numeric_limits<double>::max();
+	CGAL::Bbox_2 box = polygon->bbox();
+
+	// Iterate segment faces
+	for (auto face : *faces) {
+		// Bbox distance is a lower bound
+		CGAL::Bbox_2 face_box = face.bbox();
+		double dx = std::max(0.0, std::max(face_box.xmin() - box.xmax(), box.xmin() - face_box.xmax()));
+		double dy = std::max(0.0, std::max(face_box.ymin() - box.ymax(), box.ymin() - face_box.ymax()));
+		if (dx * dx + dy * dy >= min_dist) { continue; }
+
+		// Containment
+		if (face.bounded_side(polygon->vertex(0)) != CGAL::ON_UNBOUNDED_SIDE ||
+			polygon->bounded_side(face.vertex(0)) != CGAL::ON_UNBOUNDED_SIDE) {
+			return 0.0;
+		}
+
+		// Closest pair is a vertex of one polygon and an edge of the other
+		Polygon_2::Edge_const_iterator e;
+		Polygon_2::Vertex_const_iterator v;
+		for (e = polygon->edges_begin(); e != polygon->edges_end(); ++e) {
+			for (v = face.vertices_begin(); v != face.vertices_end(); ++v) {
+				min_dist = std::min(min_dist, CGAL::squared_distance(*e, *v));
+			}
+		}
+		for (e = face.edges_begin(); e != face.edges_end(); ++e) {
+			for (v = polygon->vertices_begin(); v != polygon->vertices_end(); ++v) {
+				min_dist = std::min(min_dist, CGAL::squared_distance(*e, *v));
+			}
+		}
+	}
+
+	return std::sqrt(min_dist);
+}
+
+
 inline std::vector<Candidate_face> compute_candidate_faces(const Mesh* mesh, unsigned int id, Plane_3* plane, std::vector<Plane_intersection>* edges, std::vector<int>* plane_edges) {
 	// Project segments on plane
 	std::vector<Segment_2> segments = project_segments(plane, edges, plane_edges);
@@ -240,7 +278,45 @@ inline std::vector<Candidate_face> compute_candidate_faces(const Mesh* mesh, uns
 
 		// Total area
 		candidate_faces[i].area = polygon.area();
+
+		// Distance to data, only for faces without coverage
+		candidate_faces[i].data_distance = (pair.second > 0.0) ? 0.0 : compute_data_distance(&polygon, &faces);
 	}
 
 	return candidate_faces;
 }
+
+
+// Link edges to the candidate faces they bound
+inline void update_edge_faces(const std::vector<Candidate_face>* faces, std::vector<Plane_intersection>* edges) {
+	for (auto& edge : *edges) { edge.faces.clear(); }
+
+	for (std::size_t j = 0; j < faces->size(); j++) {
+		for (auto e : (*faces)[j].edges) {
+			// A face may traverse the same edge twice
+			std::vector<int>& edge_faces = (*edges)[e].faces;
+			if (edge_faces.empty() || edge_faces.back() != int(j)) { edge_faces.push_back(int(j)); }
+		}
+	}
+}
+
+
+// Remove edges that bound no candidate face
+inline std::size_t remove_unused_edges(std::vector<Candidate_face>* faces, std::vector<Plane_intersection>* edges) {
+	std::vector<int> new_index(edges->size(), -1);
+	std::vector<Plane_intersection> used_edges;
+	for (std::size_t i = 0; i < edges->size(); i++) {
+		if ((*edges)[i].faces.empty()) { continue; }
+		new_index[i] = int(used_edges.size());
+		used_edges.push_back((*edges)[i]);
+	}
+
+	// Renumber face edges
+	for (auto& face : *faces) {
+		for (auto& e : face.edges) { e = new_index[e]; }
+	}
+
+	std::size_t removed = edges->size() - used_edges.size();
+	edges->swap(used_edges);
+	return removed;
+}
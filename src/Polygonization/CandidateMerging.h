@@ -0,0 +1,158 @@
+/**
+ * MeshPolygonization is the implementation of the MVS (Multi-view Stereo) building mesh simplification method
+ * described in the following paper:
+ *      Vasileios Bouzas, Hugo Ledoux, and  Liangliang Nan.
+ *      Structure-aware Building Mesh Polygonization.
+ *      ISPRS Journal of Photogrammetry and Remote Sensing. 167(2020), 432-442, 2020.
+ * Please cite the above paper if you use the code/program (or part of it).
+ *
+ * LICENSE:
+ *      MeshPolygonization is free for academic use. If you are interested in a commercial license please contact
+ *      the 3D Geoinformation group.
+ *
+ * Copyright (C) 2019 3D Geoinformation Research Group
+ * https://3d.bk.tudelft.nl/
+ */
+
+#pragma once
+
+#include "Utils.h"
+#include "CandidateFace.h"
+
+
+// Find root of face group
+inline int find_group(std::vector<int>* parent, int f) {
+	while ((*parent)[f] != f) {
+		(*parent)[f] = (*parent)[(*parent)[f]];
+		f = (*parent)[f];
+	}
+	return f;
+}
+
+
+// Merge a group of faces along their internal edges
+// Returns false if the outer boundary is not a single simple cycle
+inline bool merge_face_group(const std::vector<Candidate_face>* faces, const std::vector<int>* group,
+	                         const std::vector<bool>* internal, Candidate_face* merged) {
+	// Boundary halfedges (source vertex -> position)
+	std::vector<int> sources, targets, boundary_edges;
+	std::map<int, std::size_t> outgoing;
+	std::map<int, Point_2> points;
+	std::set<int> visited_edges;
+
+	for (auto j : *group) {
+		const Candidate_face& face = (*faces)[j];
+		std::size_t n = face.vertices.size();
+		for (std::size_t k = 0; k < n; k++) {
+			points[face.vertices[k]] = face.polygon.vertex(k);
+
+			// Skip edges interior to the group
+			int e = face.edges[k];
+			if ((*internal)[e]) { continue; }
+
+			// An edge on the boundary twice creates a slit
+			if (!visited_edges.insert(e).second) { return false; }
+
+			// Pinched boundary
+			int source = face.vertices[k];
+			if (outgoing.find(source) != outgoing.end()) { return false; }
+
+			outgoing[source] = sources.size();
+			sources.push_back(source);
+			targets.push_back(face.vertices[(k + 1) % n]);
+			boundary_edges.push_back(e);
+		}
+	}
+	if (sources.empty()) { return false; }
+
+	// Walk boundary
+	std::vector<Point_2> polygon;
+	std::size_t h = 0;
+	do {
+		merged->vertices.push_back(sources[h]);
+		merged->edges.push_back(boundary_edges[h]);
+		polygon.push_back(points[sources[h]]);
+
+		auto next = outgoing.find(targets[h]);
+		if (next == outgoing.end()) { return false; }
+		h = next->second;
+	} while (h != 0 && merged->vertices.size() <= sources.size());
+
+	// Boundary with holes or multiple cycles
+	if (h != 0 || merged->vertices.size() != sources.size()) { return false; }
+
+	// Assign geometry
+	merged->polygon = Polygon_2(polygon.begin(), polygon.end());
+
+	// Accumulate attributes
+	merged->supporting_face_num = 0;
+	merged->covered_area = 0.0;
+	merged->area = 0.0;
+	merged->data_distance = std::numeric_limits<double>::max();
+	merged->plane = (*faces)[(*group)[0]].plane;
+	for (auto j : *group) {
+		merged->supporting_face_num += (*faces)[j].supporting_face_num;
+		merged->covered_area += (*faces)[j].covered_area;
+		merged->area += (*faces)[j].area;
+		merged->data_distance = std::min(merged->data_distance, (*faces)[j].data_distance);
+	}
+
+	return true;
+}
+
+
+// Merge adjacent coplanar candidate faces
+// If the fan of an edge holds exactly two faces of the same plane, the fan constraint
+// forces both to be selected together: the edge cannot be part of any solution by
+// itself, and merging the two faces does not change the optimum.
+inline std::size_t merge_candidate_faces(std::vector<Candidate_face>* faces, std::vector<Plane_intersection>* edges) {
+	// Group faces along internal edges
+	std::vector<int> parent(faces->size());
+	for (std::size_t j = 0; j < parent.size(); j++) { parent[j] = int(j); }
+
+	std::vector<bool> internal(edges->size(), false);
+	for (std::size_t i = 0; i < edges->size(); i++) {
+		const std::vector<int>& fan = (*edges)[i].faces;
+		if (fan.size() != 2 || fan[0] == fan[1]) { continue; }
+		if ((*faces)[fan[0]].plane != (*faces)[fan[1]].plane) { continue; }
+
+		internal[i] = true;
+		int r0 = find_group(&parent, fan[0]);
+		int r1 = find_group(&parent, fan[1]);
+		if (r0 != r1) { parent[r1] = r0; }
+	}
+
+	// Collect groups in order of first face
+	std::map<int, std::vector<int>> groups;
+	std::vector<int> order;
+	for (std::size_t j = 0; j < faces->size(); j++) {
+		int root = find_group(&parent, int(j));
+		if (groups.find(root) == groups.end()) { order.push_back(root); }
+		groups[root].push_back(int(j));
+	}
+
+	// Merge groups
+	std::vector<Candidate_face> merged_faces;
+	for (auto root : order) {
+		const std::vector<int>& group = groups[root];
+		if (group.size() > 1) {
+			Candidate_face merged;
+			if (merge_face_group(faces, &group, &internal, &merged)) {
+				merged_faces.push_back(merged);
+				continue;
+			}
+		}
+
+		// Keep faces unmerged
+		for (auto j : group) { merged_faces.push_back((*faces)[j]); }
+	}
+
+	std::size_t removed = faces->size() - merged_faces.size();
+	faces->swap(merged_faces);
+
+	// Update edges
+	update_edge_faces(faces, edges);
+	remove_unused_edges(faces, edges);
+
+	return removed;
+}
@@ -0,0 +1,582 @@
+/**
+ * MeshPolygonization is the implementation of the MVS (Multi-view Stereo) building mesh simplification method
+ * described in the following paper:
+ *      Vasileios Bouzas, Hugo Ledoux, and  Liangliang Nan.
+ *      Structure-aware Building Mesh Polygonization.
+ *      ISPRS Journal of Photogrammetry and Remote Sensing. 167(2020), 432-442, 2020.
+ * Please cite the above paper if you use the code/program (or part of it).
+ *
+ * LICENSE:
+ *      MeshPolygonization is free for academic use. If you are interested in a commercial license please contact
+ *      the 3D Geoinformation group.
+ *
+ * Copyright (C) 2019 3D Geoinformation Research Group
+ * https://3d.bk.tudelft.nl/
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <charconv>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#include "CGALTypes.h"
+#include <CGAL/Polygon_mesh_processing/IO/polygon_mesh_io.h>
+#include <CGAL/Polygon_mesh_processing/repair_polygon_soup.h>
+#include <CGAL/Polygon_mesh_processing/orient_polygon_soup.h>
+#include <CGAL/Polygon_mesh_processing/polygon_soup_to_polygon_mesh.h>
+
+#ifdef _WIN32
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+// MAPPED FILE //
+// Read-only view of a whole file: memory-mapped, or read into memory where mmap is not available
+class Mapped_file {
+public:
+	explicit Mapped_file(const std::string& file) : data_(nullptr), size_(0) {
+#ifdef _WIN32
+		std::ifstream input(file.c_str(), std::ios::binary);
+		if (input.fail()) { return; }
+		buffer_.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+		data_ = buffer_.data();
+		size_ = buffer_.size();
+#else
+		int fd = ::open(file.c_str(), O_RDONLY);
+		if (fd < 0) { return; }
+		struct stat st;
+		if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+			void* data = ::mmap(nullptr, std::size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+			if (data != MAP_FAILED) {
+				::madvise(data, std::size_t(st.st_size), MADV_WILLNEED);
+				data_ = static_cast<const char*>(data);
+				size_ = std::size_t(st.st_size);
+			}
+		}
+		::close(fd);
+#endif
+	}
+
+	~Mapped_file() {
+#ifndef _WIN32
+		if (data_) { ::munmap(const_cast<char*>(data_), size_); }
+#endif
+	}
+
+	Mapped_file(const Mapped_file&) = delete;
+	Mapped_file& operator=(const Mapped_file&) = delete;
+
+	bool is_open() const { return data_ != nullptr; }
+	const char* begin() const { return data_; }
+	const char* end() const { return data_ + size_; }
+
+private:
+	const char* data_;
+	std::size_t size_;
+#ifdef _WIN32
+	std::vector<char> buffer_;
+#endif
+};
+// MAPPED FILE //
+
+
+// PARSED MESH //
+// Polygon soup as flat arrays
+struct Parsed_mesh {
+	// x, y, z of each vertex
+	std::vector<double> coordinates;
+
+	// Vertex indices of face i: indices[offsets[i]] ... indices[offsets[i + 1] - 1]
+	std::vector<int> indices;
+	std::vector<std::size_t> offsets;
+};
+// PARSED MESH //
+
+
+// Skip blanks within a line
+inline const char* skip_blanks(const char* p, const char* end) {
+	while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) { ++p; }
+	return p;
+}
+
+
+// Parse next number of a line
+template <typename T>
+inline bool parse_token(const char*& p, const char* end, T& value) {
+	p = skip_blanks(p, end);
+	if (p < end && *p == '+') { ++p; }
+	std::from_chars_result result = std::from_chars(p, end, value);
+	if (result.ec != std::errc()) { return false; }
+	p = result.ptr;
+	return true;
+}
+
+
+// Next line of [p, end), skipping empty and comment lines
+inline bool next_line(const char*& p, const char* end, const char*& line, const char*& line_end) {
+	while (p < end) {
+		const char* eol = static_cast<const char*>(std::memchr(p, '\n', std::size_t(end - p)));
+		if (!eol) { eol = end; }
+		line = skip_blanks(p, eol);
+		line_end = eol;
+		p = (eol < end) ? eol + 1 : end;
+		if (line < line_end && *line != '#') { return true; }
+	}
+	return false;
+}
+
+
+// Split [begin, end) into line-aligned chunks
+inline std::vector<const char*> split_lines(const char* begin, const char* end, std::size_t num_chunks) {
+	std::vector<const char*> bounds(1, begin);
+	std::size_t size = std::size_t(end - begin);
+	for (std::size_t c = 1; c < num_chunks; c++) {
+		const char* p = std::max(bounds.back(), begin + size * c / num_chunks);
+		const char* eol = static_cast<const char*>(std::memchr(p, '\n', std::size_t(end - p)));
+		bounds.push_back(eol ? eol + 1 : end);
+	}
+	bounds.push_back(end);
+	return bounds;
+}
+
+
+// Parse vertex and face lines in parallel
+// Lines [0, num_vertices) are vertices, the next num_faces lines are faces; further lines are ignored.
+// parse_vertex(line, line_end, xyz) and parse_face(line, line_end, indices) parse one line each.
+template <typename VertexParser, typename FaceParser>
+inline bool parse_lines(const char* begin, const char* end, std::size_t num_vertices, std::size_t num_faces,
+	                    VertexParser parse_vertex, FaceParser parse_face, Parsed_mesh* parsed) {
+	int num_threads = 1;
+#ifdef _OPENMP
+	num_threads = omp_get_max_threads();
+#endif
+	std::size_t num_chunks = std::max<std::size_t>(1, std::min<std::size_t>(std::size_t(num_threads) * 4, std::size_t(end - begin) / (1 << 16) + 1));
+	std::vector<const char*> bounds = split_lines(begin, end, num_chunks);
+
+	// Count lines of each chunk
+	std::vector<std::size_t> first_line(num_chunks + 1, 0);
+#pragma omp parallel for schedule(dynamic)
+	for (int c = 0; c < int(num_chunks); c++) {
+		const char* p = bounds[c];
+		const char *line, *line_end;
+		std::size_t count = 0;
+		while (next_line(p, bounds[c + 1], line, line_end)) { count++; }
+		first_line[c + 1] = count;
+	}
+	for (std::size_t c = 0; c < num_chunks; c++) { first_line[c + 1] += first_line[c]; }
+	if (first_line[num_chunks] < num_vertices + num_faces) { return false; }
+
+	// Parse chunks, faces go to chunk-local arrays
+	parsed->coordinates.assign(3 * num_vertices, 0.0);
+	std::vector<std::vector<int>> chunk_indices(num_chunks);
+	std::vector<std::vector<std::size_t>> chunk_degrees(num_chunks);
+	bool success = true;
+#pragma omp parallel for schedule(dynamic)
+	for (int c = 0; c < int(num_chunks); c++) {
+		const char* p = bounds[c];
+		const char *line, *line_end;
+		std::size_t idx = first_line[c];
+		while (idx < num_vertices + num_faces && next_line(p, bounds[c + 1], line, line_end)) {
+			bool ok;
+			if (idx < num_vertices) {
+				ok = parse_vertex(line, line_end, &parsed->coordinates[3 * idx]);
+			}
+			else {
+				std::size_t size = chunk_indices[c].size();
+				ok = parse_face(line, line_end, &chunk_indices[c]);
+				chunk_degrees[c].push_back(chunk_indices[c].size() - size);
+			}
+			if (!ok) {
+#pragma omp critical
+				success = false;
+				break;
+			}
+			idx++;
+		}
+	}
+	if (!success) { return false; }
+
+	// Concatenate faces in file order
+	parsed->offsets.assign(1, 0);
+	parsed->offsets.reserve(num_faces + 1);
+	for (std::size_t c = 0; c < num_chunks; c++) {
+		parsed->indices.insert(parsed->indices.end(), chunk_indices[c].begin(), chunk_indices[c].end());
+		for (auto degree : chunk_degrees[c]) { parsed->offsets.push_back(parsed->offsets.back() + degree); }
+	}
+	return parsed->offsets.size() == num_faces + 1;
+}
+
+
+// Parse index list: n i_1 ... i_n
+inline bool parse_index_list(const char*& p, const char* end, std::vector<int>* indices) {
+	int n;
+	if (!parse_token(p, end, n) || n < 3) { return false; }
+	for (int k = 0; k < n; k++) {
+		int i;
+		if (!parse_token(p, end, i)) { return false; }
+		indices->push_back(i);
+	}
+	return true;
+}
+
+
+// Parse face line of .off file (trailing values, e.g. colors, are ignored)
+inline bool parse_face_line(const char* p, const char* end, std::vector<int>* indices) {
+	return parse_index_list(p, end, indices);
+}
+
+
+// Parse ASCII .off file
+inline bool parse_off(const char* begin, const char* end, Parsed_mesh* parsed) {
+	const char* p = begin;
+	const char *line, *line_end;
+
+	// Header keyword, the counts may follow on the same line
+	if (!next_line(p, end, line, line_end)) { return false; }
+	if (line_end - line < 3 || std::strncmp(line, "OFF", 3) != 0) { return false; }
+	line += 3;
+	line = skip_blanks(line, line_end);
+	if (line == line_end && !next_line(p, end, line, line_end)) { return false; }
+
+	std::size_t num_vertices, num_faces;
+	if (!parse_token(line, line_end, num_vertices) || !parse_token(line, line_end, num_faces)) { return false; }
+
+	auto parse_vertex = [](const char* q, const char* q_end, double* xyz) {
+		return parse_token(q, q_end, xyz[0]) && parse_token(q, q_end, xyz[1]) && parse_token(q, q_end, xyz[2]);
+	};
+	return parse_lines(p, end, num_vertices, num_faces, parse_vertex, parse_face_line, parsed);
+}
+
+
+// PLY PROPERTY //
+struct Ply_property {
+	std::string name;
+
+	// Value type, and count type of list properties (empty for scalars)
+	std::string type;
+	std::string count_type;
+};
+// PLY PROPERTY //
+
+
+// Size of PLY type, 0 if unknown
+inline std::size_t ply_type_size(const std::string& type) {
+	if (type == "char" || type == "uchar" || type == "int8" || type == "uint8") { return 1; }
+	if (type == "short" || type == "ushort" || type == "int16" || type == "uint16") { return 2; }
+	if (type == "int" || type == "uint" || type == "int32" || type == "uint32" || type == "float" || type == "float32") { return 4; }
+	if (type == "double" || type == "float64") { return 8; }
+	return 0;
+}
+
+
+// Read little-endian binary PLY value
+inline double read_ply_value(const char* p, const std::string& type) {
+	switch (type[0]) {
+	case 'c': { int8_t v; std::memcpy(&v, p, 1); return v; }
+	case 'd': { double v; std::memcpy(&v, p, 8); return v; }
+	case 's': { int16_t v; std::memcpy(&v, p, 2); return v; }
+	case 'f': {
+		if (type == "float64") { double v; std::memcpy(&v, p, 8); return v; }
+		float v; std::memcpy(&v, p, 4); return v;
+	}
+	case 'i': {
+		if (type == "int8") { int8_t v; std::memcpy(&v, p, 1); return v; }
+		if (type == "int16") { int16_t v; std::memcpy(&v, p, 2); return v; }
+		int32_t v; std::memcpy(&v, p, 4); return v;
+	}
+	default: {
+		std::size_t size = ply_type_size(type);
+		if (size == 1) { uint8_t v; std::memcpy(&v, p, 1); return v; }
+		if (size == 2) { uint16_t v; std::memcpy(&v, p, 2); return v; }
+		uint32_t v; std::memcpy(&v, p, 4); return v;
+	}
+	}
+}
+
+
+// Parse .ply file, ASCII or binary little-endian, with vertex and face elements first
+inline bool parse_ply(const char* begin, const char* end, Parsed_mesh* parsed) {
+	const char* p = begin;
+	const char *line, *line_end;
+
+	// Header
+	std::string format;
+	std::vector<std::string> elements;
+	std::vector<std::size_t> counts;
+	std::vector<std::vector<Ply_property>> properties;
+	if (!next_line(p, end, line, line_end) || std::string(line, line_end).compare(0, 3, "ply") != 0) { return false; }
+	while (true) {
+		if (!next_line(p, end, line, line_end)) { return false; }
+		std::string text(line, line_end);
+		if (!text.empty() && text.back() == '\r') { text.pop_back(); }
+		std::vector<std::string> words;
+		for (std::size_t pos = 0; pos < text.size();) {
+			std::size_t next = text.find_first_of(" \t", pos);
+			if (next == std::string::npos) { next = text.size(); }
+			if (next > pos) { words.push_back(text.substr(pos, next - pos)); }
+			pos = next + 1;
+		}
+		if (words.empty() || words[0] == "comment" || words[0] == "obj_info") { continue; }
+		if (words[0] == "end_header") { break; }
+
+		if (words[0] == "format" && words.size() >= 2) { format = words[1]; }
+		else if (words[0] == "element" && words.size() >= 3) {
+			elements.push_back(words[1]);
+			counts.push_back(std::strtoull(words[2].c_str(), nullptr, 10));
+			properties.push_back(std::vector<Ply_property>());
+		}
+		else if (words[0] == "property" && !elements.empty()) {
+			Ply_property property;
+			if (words.size() >= 5 && words[1] == "list") { property.count_type = words[2]; property.type = words[3]; property.name = words[4]; }
+			else if (words.size() >= 3) { property.type = words[1]; property.name = words[2]; }
+			else { return false; }
+			if (ply_type_size(property.type) == 0) { return false; }
+			if (!property.count_type.empty() && ply_type_size(property.count_type) == 0) { return false; }
+			properties.back().push_back(property);
+		}
+		else { return false; }
+	}
+	if (elements.size() < 2 || elements[0] != "vertex" || elements[1] != "face") { return false; }
+
+	// Vertex coordinates and face indices
+	const std::vector<Ply_property>& vertex_properties = properties[0];
+	const std::vector<Ply_property>& face_properties = properties[1];
+	int axis[3] = { -1, -1, -1 };
+	for (std::size_t k = 0; k < vertex_properties.size(); k++) {
+		if (!vertex_properties[k].count_type.empty()) { return false; }
+		const std::string& name = vertex_properties[k].name;
+		if (name == "x") { axis[0] = int(k); }
+		if (name == "y") { axis[1] = int(k); }
+		if (name == "z") { axis[2] = int(k); }
+	}
+	int list = -1;
+	for (std::size_t k = 0; k < face_properties.size(); k++) {
+		const std::string& name = face_properties[k].name;
+		if (!face_properties[k].count_type.empty() && (name == "vertex_indices" || name == "vertex_index")) { list = int(k); }
+	}
+	if (axis[0] < 0 || axis[1] < 0 || axis[2] < 0 || list < 0) { return false; }
+	std::size_t num_vertices = counts[0], num_faces = counts[1];
+
+	// ASCII: one element per line
+	if (format == "ascii") {
+		auto parse_vertex = [&](const char* q, const char* q_end, double* xyz) {
+			for (std::size_t k = 0; k < vertex_properties.size(); k++) {
+				double value;
+				if (!parse_token(q, q_end, value)) { return false; }
+				for (int a = 0; a < 3; a++) { if (axis[a] == int(k)) { xyz[a] = value; } }
+			}
+			return true;
+		};
+		auto parse_face = [&](const char* q, const char* q_end, std::vector<int>* indices) {
+			for (std::size_t k = 0; k < face_properties.size(); k++) {
+				if (int(k) == list) {
+					if (!parse_index_list(q, q_end, indices)) { return false; }
+					continue;
+				}
+
+				// Other scalar or list properties are skipped
+				double value;
+				if (!parse_token(q, q_end, value)) { return false; }
+				if (face_properties[k].count_type.empty()) { continue; }
+				for (int i = 0; i < int(value); i++) {
+					if (!parse_token(q, q_end, value)) { return false; }
+				}
+			}
+			return true;
+		};
+		return parse_lines(p, end, num_vertices, num_faces, parse_vertex, parse_face, parsed);
+	}
+
+	// Binary little-endian
+	const unsigned int one = 1;
+	if (format != "binary_little_endian" || *reinterpret_cast<const unsigned char*>(&one) != 1) { return false; }
+
+	// Vertices: fixed size records
+	std::size_t offsets[3] = { 0, 0, 0 };
+	std::size_t record = 0;
+	for (std::size_t k = 0; k < vertex_properties.size(); k++) {
+		for (int a = 0; a < 3; a++) { if (axis[a] == int(k)) { offsets[a] = record; } }
+		record += ply_type_size(vertex_properties[k].type);
+	}
+	if (std::size_t(end - p) < record * num_vertices) { return false; }
+	parsed->coordinates.resize(3 * num_vertices);
+	const char* vertex_data = p;
+#pragma omp parallel for
+	for (long long i = 0; i < (long long)num_vertices; i++) {
+		const char* q = vertex_data + record * std::size_t(i);
+		for (int a = 0; a < 3; a++) {
+			parsed->coordinates[3 * i + a] = read_ply_value(q + offsets[a], vertex_properties[axis[a]].type);
+		}
+	}
+	p += record * num_vertices;
+
+	// Faces: variable size records
+	parsed->offsets.assign(1, 0);
+	parsed->offsets.reserve(num_faces + 1);
+	for (std::size_t f = 0; f < num_faces; f++) {
+		for (std::size_t k = 0; k < face_properties.size(); k++) {
+			const Ply_property& property = face_properties[k];
+			std::size_t value_size = ply_type_size(property.type);
+			if (property.count_type.empty()) {
+				if (std::size_t(end - p) < value_size) { return false; }
+				p += value_size;
+				continue;
+			}
+
+			std::size_t count_size = ply_type_size(property.count_type);
+			if (std::size_t(end - p) < count_size) { return false; }
+			long long n = (long long)read_ply_value(p, property.count_type);
+			p += count_size;
+			if (n < 0 || std::size_t(end - p) < value_size * std::size_t(n)) { return false; }
+			if (int(k) == list) {
+				if (n < 3) { return false; }
+				for (long long i = 0; i < n; i++) { parsed->indices.push_back(int(read_ply_value(p + value_size * std::size_t(i), property.type))); }
+				parsed->offsets.push_back(parsed->indices.size());
+			}
+			p += value_size * std::size_t(n);
+		}
+	}
+	return true;
+}
+
+
+// Parse .off or .ply content (format is "off" or "ply") into a polygon soup
+inline bool parse_mesh_buffer(const char* begin, const char* end, const std::string& format, Parsed_mesh* parsed) {
+	if (format != "off" && format != "ply") { return false; }
+
+	bool success = (format == "off") ? parse_off(begin, end, parsed) : parse_ply(begin, end, parsed);
+	if (!success) { return false; }
+
+	// Valid indices
+	int num_vertices = int(parsed->coordinates.size() / 3);
+	for (auto i : parsed->indices) {
+		if (i < 0 || i >= num_vertices) { return false; }
+	}
+	return true;
+}
+
+
+// Parse .off or .ply file into a polygon soup
+inline bool parse_mesh_file(const std::string& file, Parsed_mesh* parsed) {
+	std::string extension = file.substr(file.find_last_of('.') + 1);
+	for (auto& c : extension) { c = char(std::tolower(c)); }
+	if (extension != "off" && extension != "ply") { return false; }
+
+	Mapped_file mapped(file);
+	if (!mapped.is_open()) { return false; }
+	return parse_mesh_buffer(mapped.begin(), mapped.end(), extension, parsed);
+}
+
+
+// Check if a polygon soup has unreferenced vertices, duplicate points, or faces repeating a vertex
+inline bool needs_repair(const Parsed_mesh& parsed) {
+	std::size_t num_vertices = parsed.coordinates.size() / 3;
+	std::size_t num_faces = parsed.offsets.size() - 1;
+
+	// Faces
+	std::vector<char> referenced(num_vertices, 0);
+	for (std::size_t f = 0; f < num_faces; f++) {
+		for (std::size_t k = parsed.offsets[f]; k < parsed.offsets[f + 1]; k++) {
+			int v = parsed.indices[k];
+			referenced[v] = 1;
+			for (std::size_t l = parsed.offsets[f]; l < k; l++) {
+				if (parsed.indices[l] == v) { return true; }
+			}
+		}
+	}
+	for (auto r : referenced) {
+		if (!r) { return true; }
+	}
+
+	// Duplicate points: equal neighbors in lexicographic order
+	const double* xyz = parsed.coordinates.data();
+	std::vector<std::size_t> order(num_vertices);
+	for (std::size_t i = 0; i < num_vertices; i++) { order[i] = i; }
+	std::sort(order.begin(), order.end(), [xyz](std::size_t a, std::size_t b) {
+		return std::lexicographical_compare(xyz + 3 * a, xyz + 3 * a + 3, xyz + 3 * b, xyz + 3 * b + 3);
+	});
+	for (std::size_t i = 1; i < num_vertices; i++) {
+		if (std::equal(xyz + 3 * order[i - 1], xyz + 3 * order[i - 1] + 3, xyz + 3 * order[i])) { return true; }
+	}
+	return false;
+}
+
+
+// Build mesh from a polygon soup
+// Like CGAL's reader, the soup is repaired (duplicate points merged, isolated points and degenerate faces
+// removed) and oriented. A soup that needs no repair is built in one pass with reserved capacity instead,
+// and only goes through the repair if its faces do not form a 2-manifold surface.
+inline bool build_mesh(const Parsed_mesh& parsed, Mesh* mesh) {
+	std::size_t num_vertices = parsed.coordinates.size() / 3;
+	std::size_t num_faces = parsed.offsets.size() - 1;
+	mesh->clear();
+	mesh->reserve(Mesh::size_type(num_vertices), Mesh::size_type(parsed.indices.size() / 2), Mesh::size_type(num_faces));
+
+	// Points
+	std::vector<Point_3> points(num_vertices);
+#pragma omp parallel for
+	for (long long i = 0; i < (long long)num_vertices; i++) {
+		points[i] = Point_3(parsed.coordinates[3 * i], parsed.coordinates[3 * i + 1], parsed.coordinates[3 * i + 2]);
+	}
+
+	// Vertices and faces, unless the soup needs a repair
+	bool built = !needs_repair(parsed);
+	std::vector<Vertex> vertices(built ? num_vertices : 0);
+	for (std::size_t i = 0; i < vertices.size(); i++) { vertices[i] = mesh->add_vertex(points[i]); }
+	std::vector<Vertex> face_vertices;
+	for (std::size_t f = 0; f < num_faces && built; f++) {
+		face_vertices.clear();
+		for (std::size_t k = parsed.offsets[f]; k < parsed.offsets[f + 1]; k++) {
+			face_vertices.push_back(vertices[parsed.indices[k]]);
+		}
+		built = (mesh->add_face(face_vertices) != Mesh::null_face());
+	}
+	if (built) { return !mesh->is_empty(); }
+
+	// Polygon soup repair
+	std::vector<std::vector<std::size_t>> polygons(num_faces);
+	for (std::size_t f = 0; f < num_faces; f++) {
+		polygons[f].assign(parsed.indices.begin() + parsed.offsets[f], parsed.indices.begin() + parsed.offsets[f + 1]);
+	}
+	mesh->clear();
+	CGAL::Polygon_mesh_processing::repair_polygon_soup(points, polygons);
+	CGAL::Polygon_mesh_processing::orient_polygon_soup(points, polygons);
+	CGAL::Polygon_mesh_processing::polygon_soup_to_polygon_mesh(points, polygons, *mesh);
+	return !mesh->is_empty();
+}
+
+
+// Read input mesh
+// .off and .ply files are memory-mapped and parsed in parallel, other formats and unsupported variants
+// use CGAL's reader.
+inline bool readMesh(const std::string& file, Mesh* mesh) {
+	Parsed_mesh parsed;
+	if (!parse_mesh_file(file, &parsed)) {
+		return CGAL::Polygon_mesh_processing::IO::read_polygon_mesh(file, *mesh);
+	}
+	return build_mesh(parsed, mesh);
+}
+
+
+// Read input mesh from .off or .ply content in memory (format is "off" or "ply")
+inline bool readMesh(const char* begin, const char* end, const std::string& format, Mesh* mesh) {
+	Parsed_mesh parsed;
+	if (!parse_mesh_buffer(begin, end, format, &parsed)) { return false; }
+	return build_mesh(parsed, mesh);
+}
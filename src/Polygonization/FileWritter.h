@@ -17,6 +17,9 @@
 #pragma once
 
 #include <fstream>
+#include <iomanip>
+#include <charconv>
+#include <cstring>
 
 #include "Segment.h"
 #include "rply.h"
@@ -133,59 +136,224 @@ inline void writeMesh(const Mesh* mesh, std::string file) {
 }
 
 
-// Write simplified mesh
-inline void writeSimplified(const Mesh* mesh, std::string file) {
-	// Initialize .ply file
-	p_ply ply = ply_create(file.c_str(), PLY_ASCII, NULL, 0, NULL);
+// OUTPUT PARAMETERS //
+struct Output_parameters {
+	enum Format { PLY_ASCII, PLY_BINARY, OBJ };
 
-	// Vertices
-	const char* name = "vertex";
-	long ninstances = mesh->num_vertices();
-	ply_add_element(ply, name, ninstances);
+	// File format of the simplified mesh
+	Format format = PLY_ASCII;
 
-	ply_add_scalar_property(ply, "x", PLY_DOUBLE);
-	ply_add_scalar_property(ply, "y", PLY_DOUBLE);
-	ply_add_scalar_property(ply, "z", PLY_DOUBLE);
+	// Triangulate the selected faces, otherwise the planar polygons are kept
+	bool triangulate = true;
+};
+// OUTPUT PARAMETERS //
 
-	// Faces
-	name = "face";
-	ninstances = mesh->num_faces();
-	ply_add_element(ply, name, ninstances);
 
-	ply_add_list_property(ply, "vertex_indices", PLY_UCHAR, PLY_INT);
-	/*ply_add_scalar_property(ply, "supporting_face_num", PLY_DOUBLE);
-	ply_add_scalar_property(ply, "covered_area", PLY_DOUBLE);*/
+// File extension of output format
+inline std::string output_extension(Output_parameters::Format format) {
+	return (format == Output_parameters::OBJ) ? ".obj" : ".ply";
+}
 
-	// Header
-	ply_write_header(ply);
 
+// Buffered file writer, or writer appending to a string
+// Numbers are formatted with std::to_chars (shortest representation that reads back exactly),
+// binary values are written little-endian
+class Buffered_writer {
+public:
+	explicit Buffered_writer(const std::string& file) : file_(std::fopen(file.c_str(), "wb")), string_(nullptr) { buffer_.reserve(capacity); }
+	explicit Buffered_writer(std::string* output) : file_(nullptr), string_(output) { buffer_.reserve(capacity); }
+	~Buffered_writer() { close(); }
+
+	bool is_open() const { return file_ != nullptr || string_ != nullptr; }
+
+	bool close() {
+		if (!is_open()) { return false; }
+		flush();
+		bool ok = !failed_ && (!file_ || std::fclose(file_) == 0);
+		file_ = nullptr;
+		string_ = nullptr;
+		return ok;
+	}
+
+	void text(const char* str) { append(str, std::strlen(str)); }
+	void text(const std::string& str) { append(str.data(), str.size()); }
+	void put(char c) { reserve(1); buffer_.push_back(c); }
+
+	// ASCII number
+	template <typename T>
+	void number(T value) {
+		char str[32];
+		std::to_chars_result result = std::to_chars(str, str + sizeof(str), value);
+		append(str, std::size_t(result.ptr - str));
+	}
+
+	// Little-endian binary value
+	template <typename T>
+	void binary(T value) {
+		char bytes[sizeof(T)];
+		std::memcpy(bytes, &value, sizeof(T));
+		const unsigned int one = 1;
+		if (*reinterpret_cast<const unsigned char*>(&one) != 1) { std::reverse(bytes, bytes + sizeof(T)); }
+		append(bytes, sizeof(T));
+	}
+
+private:
+	static const std::size_t capacity = 1 << 16;
+
+	void append(const char* data, std::size_t size) {
+		reserve(size);
+		buffer_.insert(buffer_.end(), data, data + size);
+	}
+
+	void reserve(std::size_t size) {
+		if (buffer_.size() + size > capacity) { flush(); }
+	}
+
+	void flush() {
+		if (file_ && !buffer_.empty() && std::fwrite(buffer_.data(), 1, buffer_.size(), file_) != buffer_.size()) { failed_ = true; }
+		if (string_) { string_->append(buffer_.data(), buffer_.size()); }
+		buffer_.clear();
+	}
+
+private:
+	std::FILE* file_;
+	std::string* string_;
+	std::vector<char> buffer_;
+	bool failed_ = false;
+};
+
+
+// Write simplified mesh (.ply, ASCII or binary little-endian, or .obj)
+// Faces are written as they are in the mesh: triangles, or planar polygons if not triangulated
+inline void write_simplified(const Mesh* mesh, Buffered_writer& out, Output_parameters::Format format) {
 	// Vertex properties
 	VProp_geom geom = mesh->points();
 
-	// Write vertices
+	// Largest face, for the type of the index list count
+	std::size_t max_degree = 0;
+	for (auto f : mesh->faces()) {
+		max_degree = std::max(max_degree, std::size_t(mesh->degree(f)));
+	}
+	bool wide_count = max_degree > 255;
+
+	// Header
+	if (format == Output_parameters::OBJ) {
+		out.text("# MeshPolygonization\n");
+	}
+	else {
+		out.text("ply\n");
+		out.text((format == Output_parameters::PLY_BINARY) ? "format binary_little_endian 1.0\n" : "format ascii 1.0\n");
+		out.text("element vertex "); out.number(mesh->number_of_vertices()); out.put('\n');
+		out.text("property double x\nproperty double y\nproperty double z\n");
+		out.text("element face "); out.number(mesh->number_of_faces()); out.put('\n');
+		out.text(wide_count ? "property list int int vertex_indices\n" : "property list uchar int vertex_indices\n");
+		out.text("end_header\n");
+	}
+
+	// Write vertices, skipping removed ones in the indices
+	std::vector<std::size_t> indices(mesh->num_vertices(), 0);
+	std::size_t num_written = 0;
 	for (auto v : mesh->vertices()) {
+		indices[v] = num_written++;
+
 		Point_3 point = geom[v];
-		ply_write(ply, point.x());
-		ply_write(ply, point.y());
-		ply_write(ply, point.z());
+		if (format == Output_parameters::PLY_BINARY) {
+			out.binary(double(point.x()));
+			out.binary(double(point.y()));
+			out.binary(double(point.z()));
+			continue;
+		}
+		if (format == Output_parameters::OBJ) { out.text("v "); }
+		out.number(double(point.x())); out.put(' ');
+		out.number(double(point.y())); out.put(' ');
+		out.number(double(point.z())); out.put('\n');
 	}
 
 	// Write faces
 	std::vector<Vertex> vertices;
-
 	for (auto f : mesh->faces()) {
 		// Collect face vertices
 		vertices = vertex_around_face(mesh, f);
 
-		ply_write(ply, vertices.size());
-		for (auto v : vertices) {
-			ply_write(ply, v);
+		if (format == Output_parameters::PLY_BINARY) {
+			if (wide_count) { out.binary(int(vertices.size())); }
+			else { out.binary((unsigned char)(vertices.size())); }
+			for (auto v : vertices) { out.binary(int(indices[v])); }
+			continue;
 		}
+		if (format == Output_parameters::OBJ) {
+			out.put('f');
+			for (auto v : vertices) { out.put(' '); out.number(indices[v] + 1); }
+			out.put('\n');
+			continue;
+		}
+		out.number(vertices.size());
+		for (auto v : vertices) { out.put(' '); out.number(indices[v]); }
+		out.put('\n');
+	}
+}
 
-		/*ply_write(ply, supporting_face_num[f]);
-		ply_write(ply, covered_area[f]);*/
+
+// Write simplified mesh to file
+inline bool writeSimplified(const Mesh* mesh, std::string file, Output_parameters::Format format = Output_parameters::PLY_ASCII) {
+	Buffered_writer out(file);
+	if (!out.is_open()) {
+		std::cerr << "Failed to create file \'" << file << "\'" << std::endl;
+		return false;
 	}
 
+	write_simplified(mesh, out, format);
+
 	// Close
-	ply_close(ply);
+	if (!out.close()) {
+		std::cerr << "Failed to write file \'" << file << "\'" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+
+// Write simplified mesh to a string, in the same format as the file
+inline void writeSimplified(const Mesh* mesh, std::string* output, Output_parameters::Format format = Output_parameters::PLY_ASCII) {
+	Buffered_writer out(output);
+	write_simplified(mesh, out, format);
+	out.close();
+}
+
+
+// Write candidate faces as a polygon soup (.off)
+inline bool writeCandidates(const std::vector<Point_3>* points, const std::vector<std::vector<int>>* polygons, std::string file) {
+	// Open file
+	std::ofstream fout(file.c_str());
+	if (!fout.is_open()) {
+		std::cerr << "Failed to create file \'" << file << "\'" << std::endl;
+		return false;
+	}
+	fout << std::setprecision(17);
+
+	// Header
+	fout << "OFF" << std::endl;
+	fout << points->size() << " " << polygons->size() << " 0" << std::endl;
+
+	// Write vertices
+	for (auto point : *points) {
+		fout << point.x() << " " << point.y() << " " << point.z() << std::endl;
+	}
+
+	// Write faces
+	for (auto polygon : *polygons) {
+		fout << polygon.size();
+		for (auto i : polygon) {
+			fout << " " << i;
+		}
+		fout << std::endl;
+	}
+
+	// Close
+	fout.close();
+	if (fout.fail()) {
+		std::cerr << "Failed to write file \'" << file << "\'" << std::endl;
+		return false;
+	}
+	return true;
 }
@@ -17,58 +17,137 @@
 #pragma once
 
 #include "Utils.h"
+#include "Presolve.h"
 #include "solver/linear_program_solver.h"
+#include "solver/fan_program.h"
 
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <iomanip>
+#include <fstream>
 
-inline std::vector<double> optimize(Mesh* mesh, std::vector<Plane_intersection>* edges, LinearProgramSolver::SolverName solver_name) {
-	// Face attributes //
-	// Face index
-	Mesh::Property_map<Face, std::size_t> face_indices = mesh->property_map<Face, std::size_t>("f:index").value();
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
-	// Number of supporting faces
-	Mesh::Property_map<Face, std::size_t> supporting_face_num = mesh->property_map<Face, std::size_t>("f:supporting_face_num").value();
 
-	// Covered area
-	Mesh::Property_map<Face, double> covered_area = mesh->property_map<Face, double>("f:covered_area").value();
+// OPTIMIZATION PARAMETERS //
+// Objective weights of the data fitting, model coverage and model complexity terms
+struct Objective_weights {
+	double fitting = 0.43;
+	double coverage = 0.27;
+	double complexity = 0.30;
+};
 
-	// Total area
-	Mesh::Property_map<Face, double> area = mesh->property_map<Face, double>("f:area").value();
+struct Optimization_parameters {
+	// Objective weights
+	Objective_weights weights;
 
+	// Lazy fan constraints: only fans with a face decreasing the objective are added up front,
+	// the other fans are enforced once violated
+	bool lazy_constraints = true;
+
+	// Solver budget: the time limit and threads are shared by all components (the components
+	// solved at the same time split the threads), the node limit and relative gap apply to each
+	LinearProgramSolver::Budget budget;
+
+	// Directory of the on-disk cache of optimal component solutions (empty to disable)
+	std::string cache_directory;
+
+	// Solver telemetry: one JSON line per component, appended by each optimization run (empty to disable)
+	std::string report_file;
+
+	// Print the presolve, component, telemetry and objective summaries, and the solver messages
+	bool verbose = true;
+};
+// OPTIMIZATION PARAMETERS //
+
+
+// Construct face selection program of a component
+// x[0] ... x[nf - 1] : faces of the component, x[nf] ... : edges used of its fans
+inline void build_component_program(const Presolved_program* presolved, const Fan_component* component,
+	                                const std::vector<std::size_t>* local_faces, ColumnarProgram* program, bool lazy) {
+	std::size_t num_faces = component->faces.size();
+	std::size_t num_variables = num_faces + component->fans.size();
+
+	std::size_t num_nonzeros = 0;
+	for (auto k : component->fans) { num_nonzeros += presolved->fans[k].size() + 1; }
+	program->reserve(num_variables, component->fans.size(), num_nonzeros);
+
+	// Add variable
+	program->add_variables(num_variables, ColumnarProgram::BINARY, 0.0, 1.0);
+
+	// Add objective: MINIMIZATION
+	program->set_sense(LinearObjective::MINIMIZE);
+	for (std::size_t i = 0; i < num_faces; ++i) {
+		program->set_objective_coefficient(i, presolved->costs[component->faces[i]]);
+	}
+
+	// Adds constraints: the number of faces associated with an edge must be either 2 or 0
+	for (std::size_t k = 0; k < component->fans.size(); k++) {
+		// Fans of rejected faces are rarely violated
+		bool core = false;
+		for (auto f : presolved->fans[component->fans[k]]) {
+			if (presolved->costs[f] < 0.0) { core = true; break; }
+		}
+
+		program->add_constraint(0.0, 0.0, lazy && !core);
+		for (auto f : presolved->fans[component->fans[k]]) {
+			program->add_coefficient(int((*local_faces)[f]), 1.0);
+		}
+
+		// If edge is adjacent to more than 2 faces, choose two of them
+		program->add_coefficient(int(num_faces + k), -2.0);
+	}
+}
+
+
+// FACE SELECTION PROBLEM //
+// Binary variables:
+// x[0] ... x[num_faces - 1] : binary labels of all the input faces
+// x[num_faces] ... x[num_faces + num_edges - 1] : binary labels of all the intersecting edges (remain or not)
+// x[num_faces + num_edges] ... x[num_faces + 2 * num_edges - 1] : complexity labels of all the intersecting edges
+// The complexity labels (cost complexity_cost) are not constrained, so presolve fixes them to 0.
+struct Face_selection_problem {
+	// Objective coefficient of each face
+	std::vector<double> costs;
+
+	// Faces sharing each edge: the number of selected faces must be either 2 or 0
+	std::vector<std::vector<std::size_t>> fans;
+
+	// Objective coefficient of each complexity label
+	double complexity_cost = 0.0;
+};
+// FACE SELECTION PROBLEM //
+
+
+// Compute objective coefficients and edge fans of the candidate faces
+inline Face_selection_problem compute_selection_problem(const std::vector<Triple_intersection>* vertices, const std::vector<Candidate_face>* faces,
+	                                                    const std::vector<Plane_intersection>* edges, const Objective_weights& weights) {
 	// Linear program coefficients
-	double wt_fitting = 0.43;
-	double wt_coverage = 0.27;
-	double wt_complexity = 0.30;
+	double wt_fitting = weights.fitting;
+	double wt_coverage = weights.coverage;
+	double wt_complexity = weights.complexity;
 
 	// Compute total number of supporting faces of the model
 	double total_faces = 0.0;
 	double total_area = 0.0;
-	std::size_t idx = 0;
-	for (auto f : mesh->faces()) {
-		total_faces += supporting_face_num[f];
-		total_area += area[f];
-		face_indices[f] = idx;
-		++idx;
+	for (auto& face : *faces) {
+		total_faces += face.supporting_face_num;
+		total_area += face.area;
 	}
 
-	// Binary variables:
-	// x[0] ... x[num_faces - 1] : binary labels of all the input faces
-	// x[num_faces] ... x[num_faces + num_edges - 1] : binary labels of all the intersecting edges (remain or not)
-
 	// Determine variable number
-	std::size_t num_faces = mesh->number_of_faces();
+	std::size_t num_faces = faces->size();
 	std::size_t num_edges = edges->size();
-	std::size_t total_variables = num_faces + num_edges + num_edges;
 
-    LinearProgram program;
-	// Add variable
-	const std::vector<Variable*>& variables = program.create_n_variables(total_variables);
-	for (std::size_t i = 0; i < total_variables; ++i) {
-		Variable* v = variables[i];
-		v->set_variable_type(Variable::BINARY);
+	// Candidate faces bbox area
+	Bbox_3 box;
+	for (auto& face : *faces) {
+		for (auto i : face.vertices) { box += (*vertices)[i].point.bbox(); }
 	}
-
-	// Proxy mesh bbox area
-	Bbox_3 box = CGAL::Polygon_mesh_processing::bbox(*mesh);
 	double dx = box.xmax() - box.xmin();
 	double dy = box.ymax() - box.ymin();
 	double dz = box.zmax() - box.zmin();
@@ -79,57 +158,262 @@ inline std::vector<double> optimize(Mesh* mesh, std::vector<Plane_intersection>*
 	double coeff_coverage = wt_coverage / box_area;
 	double coeff_complexity = wt_complexity / double(edges->size());
 
-	// Add objective: MINIMIZATION 
-	LinearObjective* objective = program.create_objective(LinearObjective::MINIMIZE);
+	Face_selection_problem problem;
+	problem.complexity_cost = coeff_complexity;
 
-	for (auto f : mesh->faces()) {
-		std::size_t var_idx = face_indices[f];
+	// Face objective coefficients
+	problem.costs.assign(num_faces, 0.0);
+	for (std::size_t j = 0; j < num_faces; j++) {
+		const Candidate_face& face = (*faces)[j];
 
 		// Accumulates data fitting term
-		double num = supporting_face_num[f];
-		objective->add_coefficient(var_idx, -coeff_data_fitting * num);
+		double num = face.supporting_face_num;
+		problem.costs[j] -= coeff_data_fitting * num;
 
 		// Accumulates model coverage term
-		double uncovered_area = (area[f] - covered_area[f]);
-		objective->add_coefficient(var_idx, coeff_coverage * uncovered_area);
+		double uncovered_area = (face.area - face.covered_area);
+		problem.costs[j] += coeff_coverage * uncovered_area;
+	}
+
+	// Edge fans, filled from the edge list of each face
+	problem.fans.resize(num_edges);
+	for (std::size_t j = 0; j < num_faces; j++) {
+		std::set<int> face_edges((*faces)[j].edges.begin(), (*faces)[j].edges.end());
+		for (auto e : face_edges) { problem.fans[e].push_back(j); }
 	}
 
-	std::size_t num_sharp_edges = 0;
-	for (std::size_t i = 0; i < edges->size(); ++i) {
-		std::size_t var_idx = num_faces + num_edges + num_sharp_edges;
+	return problem;
+}
 
-		// Accumulates model complexity term
-		objective->add_coefficient(var_idx, coeff_complexity);
-		++num_sharp_edges;
+
+// Construct the complete face selection program (before presolve), e.g., to be solved offline
+// Variables are named f<i> (faces), e<i> (edges used) and c<i> (complexity labels)
+inline void build_selection_program(const Face_selection_problem* problem, LinearProgram* program) {
+	std::size_t num_faces = problem->costs.size();
+	std::size_t num_edges = problem->fans.size();
+
+	// Add variables
+	for (std::size_t i = 0; i < num_faces; i++) {
+		program->create_variable(Variable::BINARY, Variable::DOUBLE, 0.0, 1.0, "f" + std::to_string(i));
+	}
+	for (std::size_t i = 0; i < num_edges; i++) {
+		program->create_variable(Variable::BINARY, Variable::DOUBLE, 0.0, 1.0, "e" + std::to_string(i));
+	}
+	for (std::size_t i = 0; i < num_edges; i++) {
+		program->create_variable(Variable::BINARY, Variable::DOUBLE, 0.0, 1.0, "c" + std::to_string(i));
+	}
+
+	// Add objective: MINIMIZATION
+	LinearObjective* objective = program->create_objective(LinearObjective::MINIMIZE);
+	for (std::size_t i = 0; i < num_faces; i++) {
+		objective->add_coefficient(int(i), problem->costs[i]);
+	}
+	for (std::size_t i = 0; i < num_edges; i++) {
+		objective->add_coefficient(int(num_faces + num_edges + i), problem->complexity_cost);
 	}
 
 	// Adds constraints: the number of faces associated with an edge must be either 2 or 0
-	std::size_t var_edge_used_idx = 0;
-	for (std::size_t i = 0; i < edges->size(); i++) {
-		LinearConstraint* c = program.create_constraint(LinearConstraint::FIXED, 0.0, 0.0);
-		auto fan = (*edges)[i].fan;
-		for (std::size_t j = 0; j < fan.size(); ++j) {
-			auto f = fan[j];
-			std::size_t var_idx = face_indices[f];
-			c->add_coefficient(var_idx, 1.0);
+	for (std::size_t i = 0; i < num_edges; i++) {
+		LinearConstraint* constraint = program->create_constraint(LinearConstraint::FIXED, 0.0, 0.0, "fan" + std::to_string(i));
+		for (auto f : problem->fans[i]) {
+			constraint->add_coefficient(int(f), 1.0);
 		}
+		constraint->add_coefficient(int(num_faces + i), -2.0);
+	}
+}
 
-		// If edge is adjacent to less than 2 faces, delete them
-		// If edge is adjacent to more than 2 faces, choose two of them
-		if (fan.size() >= 2) {
-			std::size_t var_idx = num_faces + var_edge_used_idx;
-			c->add_coefficient(var_idx, -2.0);
-			++var_edge_used_idx;
-		}
+
+// Names of the variables of build_selection_program()
+inline std::vector<std::string> selection_variable_names(std::size_t num_faces, std::size_t num_edges) {
+	std::vector<std::string> names;
+	for (std::size_t i = 0; i < num_faces; i++) { names.push_back("f" + std::to_string(i)); }
+	for (std::size_t i = 0; i < num_edges; i++) { names.push_back("e" + std::to_string(i)); }
+	for (std::size_t i = 0; i < num_edges; i++) { names.push_back("c" + std::to_string(i)); }
+	return names;
+}
+
+
+// Summarize solver telemetry and write one JSON line per component
+inline void report_components(const std::vector<Fan_component>* components, const std::vector<LinearProgramSolver::SolveReport>* reports,
+	                          const std::string& file_name, bool verbose) {
+	long long total_nodes = 0;
+	double presolve_time = 0.0;
+	std::size_t slowest = 0;
+	for (std::size_t c = 0; c < reports->size(); c++) {
+		const LinearProgramSolver::SolveReport& report = (*reports)[c];
+		if (report.node_count > 0) { total_nodes += report.node_count; }
+		if (report.presolve_time > 0.0) { presolve_time += report.presolve_time; }
+		if (report.solve_time > (*reports)[slowest].solve_time) { slowest = c; }
+	}
+	if (reports->empty()) { return; }
+
+	const LinearProgramSolver::SolveReport& worst = (*reports)[slowest];
+	if (verbose) {
+		std::cout << "Solver telemetry: " << total_nodes << " nodes, " << presolve_time << " s presolve, slowest component "
+			      << slowest << " (" << (*components)[slowest].faces.size() << " faces, " << worst.solve_time << " s, "
+			      << ((worst.status == LinearProgramSolver::OPTIMAL) ? "optimal" : "not optimal") << ")" << std::endl;
+	}
+
+	if (file_name.empty()) { return; }
+
+	// Concurrent runs (batch, service) append whole runs, numbered from 0 in each process
+	static std::mutex file_mutex;
+	static std::size_t num_runs = 0;
+	std::lock_guard<std::mutex> lock(file_mutex);
+	std::ofstream output(file_name.c_str(), std::ios::app);
+	if (output.fail()) {
+		std::cerr << "Failed to open telemetry file \'" << file_name << "\'" << std::endl;
+		return;
+	}
+	std::size_t run = num_runs++;
+	for (std::size_t c = 0; c < reports->size(); c++) {
+		std::string json = (*reports)[c].to_json();
+		output << "{\"run\": " << run << ", \"component\": " << c << ", \"faces\": " << (*components)[c].faces.size() << ", " << json.substr(1) << std::endl;
+	}
+}
+
+
+inline std::vector<double> optimize(const Face_selection_problem* problem, LinearProgramSolver::SolverName solver_name,
+	                                const Optimization_parameters& params) {
+	const std::vector<double>& costs = problem->costs;
+	const std::vector<std::vector<std::size_t>>& fans = problem->fans;
+	std::size_t num_edges = fans.size();
+	std::size_t total_variables = costs.size() + num_edges + num_edges;
+
+	// Presolve
+	Presolved_program presolved = presolve_fans(&costs, &fans);
+	std::size_t num_variables = presolved.faces.size() + presolved.fans.size();
+	if (params.verbose) {
+		std::cout << "Presolve: " << total_variables << " variables, " << num_edges << " constraints -> "
+			      << num_variables << " variables, " << presolved.fans.size() << " constraints" << std::endl;
 	}
 
 	// Optimization
 	std::vector<double> X;
 
-    LinearProgramSolver solver;
-	if (solver.solve(&program, solver_name)) {
+	// Nothing left to optimize
+	if (presolved.faces.empty()) {
+		std::vector<double> empty;
+		X = postsolve_fans(&presolved, &empty, num_edges);
+		X.resize(total_variables, 0.0);
+		return X;
+	}
+
+	// Independent components
+	std::vector<std::size_t> local_faces;
+	std::vector<Fan_component> components = split_components(&presolved, &local_faces);
+	if (params.verbose) { std::cout << "Components: " << components.size() << std::endl; }
+
+	// Solve components in parallel, largest first, within the shared time limit
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point t0 = Clock::now();
+	std::vector<double> solution(num_variables, 0.0);
+	std::size_t num_optimal = 0, num_feasible = 0, num_fallback = 0;
+	double max_gap = 0.0;
+	bool success = true;
+	std::unique_ptr<SolutionCache> cache;
+	if (!params.cache_directory.empty()) { cache.reset(new SolutionCache(params.cache_directory)); }
+	std::vector<LinearProgramSolver::SolveReport> reports(components.size());
+
+	// The components solved at the same time share the thread budget
+	int total_threads = params.budget.num_threads;
+	if (total_threads <= 0) {
+#ifdef _OPENMP
+		total_threads = omp_get_max_threads();
+#else
+		total_threads = int(std::max(1u, std::thread::hardware_concurrency()));
+#endif
+	}
+	int num_concurrent = std::max(1, std::min(int(components.size()), total_threads));
+	int component_threads = std::max(1, total_threads / num_concurrent);
+#pragma omp parallel for schedule(dynamic) num_threads(num_concurrent)
+	for (int c = 0; c < int(components.size()); c++) {
+		const Fan_component& component = components[c];
+
+		ColumnarProgram program;
+		build_component_program(&presolved, &component, &local_faces, &program, params.lazy_constraints);
+
+		// Warm start from a greedy feasible selection
+		FanProgram fan_program;
+		std::vector<double> start;
+		if (fan_program.extract(&program)) {
+			start = fan_program.to_solution(fan_program.greedy_selection());
+			program.set_mip_start(start);
+		}
+
+		// Remaining time
+		LinearProgramSolver::Budget budget = params.budget;
+		budget.num_threads = component_threads;
+		if (budget.time_limit >= 0.0) {
+			double elapsed = std::chrono::duration<double>(Clock::now() - t0).count();
+			budget.time_limit = std::max(0.0, budget.time_limit - elapsed);
+		}
+
+		LinearProgramSolver solver;
+		solver.set_budget(budget);
+		solver.set_cache(cache.get());
+		solver.set_verbose(params.verbose);
+		const std::vector<double>* result = &start;
+		bool solved = solver.solve(&program, solver_name);
+		reports[c] = solver.report();
+		if (solved) {
+			result = &solver.solution();
+#pragma omp critical
+			{
+				if (solver.status() == LinearProgramSolver::OPTIMAL) { num_optimal++; }
+				else { num_feasible++; }
+				max_gap = std::max(max_gap, solver.gap());
+			}
+		}
+		else if (!start.empty()) {
+			// Fall back to the warm start, which is feasible
+#pragma omp critical
+			num_fallback++;
+		}
+		else {
+#pragma omp critical
+			success = false;
+			continue;
+		}
+
 		// Marks results
-		X = solver.solution();
+		for (std::size_t i = 0; i < component.faces.size(); i++) {
+			solution[component.faces[i]] = (*result)[i];
+		}
+		for (std::size_t k = 0; k < component.fans.size(); k++) {
+			solution[presolved.faces.size() + component.fans[k]] = (*result)[component.faces.size() + k];
+		}
+	}
+
+	if (params.verbose) {
+		std::cout << "Solved components: " << num_optimal << " optimal, " << num_feasible << " feasible (max gap: "
+			      << 100.0 * max_gap << "%), " << num_fallback << " warm start";
+		if (!success) { std::cout << ", some failed"; }
+		std::cout << std::endl;
+	}
+	report_components(&components, &reports, params.report_file, params.verbose);
+	if (cache && params.verbose) {
+		std::cout << "Solution cache: " << cache->num_hits() << " hits, " << cache->num_misses() << " misses" << std::endl;
+	}
+
+	if (success) {
+		X = postsolve_fans(&presolved, &solution, num_edges);
+		X.resize(total_variables, 0.0);
+
+		// Objective of the complete program, comparable between solvers
+		if (params.verbose) {
+			double objective = 0.0;
+			for (std::size_t f = 0; f < costs.size(); f++) { objective += costs[f] * X[f]; }
+			std::cout << "Objective: " << std::setprecision(10) << objective << std::endl;
+		}
 	}
 	return X;
-}
\ No newline at end of file
+}
+
+
+inline std::vector<double> optimize(const std::vector<Triple_intersection>* vertices, const std::vector<Candidate_face>* faces,
+	                                const std::vector<Plane_intersection>* edges, LinearProgramSolver::SolverName solver_name,
+	                                const Optimization_parameters& params) {
+	Face_selection_problem problem = compute_selection_problem(vertices, faces, edges, params.weights);
+	return optimize(&problem, solver_name, params);
+}
@@ -22,24 +22,11 @@
 #include <CGAL/Polygon_mesh_processing/orientation.h>
 #include <CGAL/Polygon_mesh_processing/triangulate_faces.h>
 
-void orient(Mesh& mesh, const std::vector<Triple_intersection>& vertices) {
-	// Retrieve mesh points
-	std::vector<Point_3> points;
-	for (auto vertex : vertices) {
-		points.push_back(vertex.point);
-	}
-
-	// Construct polygons to be oriented
-	Mesh::Property_map<Face, std::vector<int>> vertex_indices = mesh.property_map<Face, std::vector<int>>("f:vertices").value();
-	std::vector<std::vector<int>> polygons;
-	for (auto f : mesh.faces()) {
-		// Retrieve vertex indices
-		std::vector<int> polygon = vertex_indices[f];
-
-		// Add to polygons
-		polygons.push_back(polygon);
-	}
+#include <map>
+#include <deque>
 
+// Orient polygon soup and convert it to mesh
+inline void orient_polygons(Mesh& mesh, std::vector<Point_3>& points, std::vector<std::vector<int>>& polygons, bool triangulate = true) {
 	CGAL::Polygon_mesh_processing::orient_polygon_soup(points, polygons);
 	mesh.clear();
 	CGAL::Polygon_mesh_processing::polygon_soup_to_polygon_mesh(points, polygons, mesh);
@@ -50,9 +37,138 @@ void orient(Mesh& mesh, const std::vector<Triple_intersection>& vertices) {
 	}
 	mesh.collect_garbage();
 
-    if (!CGAL::is_triangle_mesh(mesh))
+    if (triangulate && !CGAL::is_triangle_mesh(mesh))
         CGAL::Polygon_mesh_processing::triangulate_faces(mesh);
 
 	if (CGAL::is_closed(mesh) && (!CGAL::Polygon_mesh_processing::is_outward_oriented(mesh)))
 		CGAL::Polygon_mesh_processing::reverse_face_orientations(mesh);
+}
+
+
+// Propagate a consistent orientation across shared edges
+// Neighbor faces must traverse their shared edge in opposite directions. Each closed component
+// is then made outward-oriented by the sign of its volume. Returns false (and leaves the faces
+// untouched) if an edge is shared by more than two faces or a component is not orientable.
+inline bool propagate_orientation(const std::vector<Point_3>& points, std::vector<std::vector<int>>& polygons) {
+	// Faces traversing each undirected edge, with their direction
+	std::map<std::pair<int, int>, std::vector<std::pair<std::size_t, bool>>> edge_faces;
+	for (std::size_t j = 0; j < polygons.size(); j++) {
+		const std::vector<int>& polygon = polygons[j];
+		for (std::size_t k = 0; k < polygon.size(); k++) {
+			int a = polygon[k], b = polygon[(k + 1) % polygon.size()];
+			std::vector<std::pair<std::size_t, bool>>& fan = edge_faces[std::make_pair(std::min(a, b), std::max(a, b))];
+			fan.push_back(std::make_pair(j, a < b));
+			if (fan.size() > 2) { return false; }
+		}
+	}
+
+	// Face adjacency: neighbor and whether it traverses the shared edge in the same direction
+	std::vector<std::vector<std::pair<std::size_t, bool>>> adjacency(polygons.size());
+	std::vector<bool> on_border(polygons.size(), false);
+	for (auto& pair : edge_faces) {
+		const std::vector<std::pair<std::size_t, bool>>& fan = pair.second;
+		if (fan.size() < 2) { on_border[fan[0].first] = true; continue; }
+
+		bool same = (fan[0].second == fan[1].second);
+		adjacency[fan[0].first].push_back(std::make_pair(fan[1].first, same));
+		adjacency[fan[1].first].push_back(std::make_pair(fan[0].first, same));
+	}
+
+	// Breadth-first propagation, one component at a time
+	std::vector<int> flip(polygons.size(), -1);
+	std::vector<std::vector<std::size_t>> components;
+	for (std::size_t seed = 0; seed < polygons.size(); seed++) {
+		if (flip[seed] >= 0) { continue; }
+
+		std::vector<std::size_t> component;
+		std::deque<std::size_t> queue;
+		flip[seed] = 0;
+		queue.push_back(seed);
+		while (!queue.empty()) {
+			std::size_t j = queue.front();
+			queue.pop_front();
+			component.push_back(j);
+
+			for (auto& neighbor : adjacency[j]) {
+				int expected = neighbor.second ? 1 - flip[j] : flip[j];
+				if (flip[neighbor.first] < 0) {
+					flip[neighbor.first] = expected;
+					queue.push_back(neighbor.first);
+				}
+				else if (flip[neighbor.first] != expected) { return false; } // Not orientable
+			}
+		}
+		components.push_back(component);
+	}
+
+	// Outward orientation of closed components, by the sign of their volume
+	for (auto& component : components) {
+		bool closed = true;
+		double volume = 0.0;
+		for (auto j : component) {
+			if (on_border[j]) { closed = false; break; }
+
+			const std::vector<int>& polygon = polygons[j];
+			Vector_3 p0 = points[polygon[0]] - CGAL::ORIGIN;
+			double face_volume = 0.0;
+			for (std::size_t k = 1; k + 1 < polygon.size(); k++) {
+				Vector_3 p1 = points[polygon[k]] - CGAL::ORIGIN;
+				Vector_3 p2 = points[polygon[k + 1]] - CGAL::ORIGIN;
+				face_volume += p0 * CGAL::cross_product(p1, p2);
+			}
+			volume += flip[j] ? -face_volume : face_volume;
+		}
+		if (closed && volume < 0.0) {
+			for (auto j : component) { flip[j] = 1 - flip[j]; }
+		}
+	}
+
+	for (std::size_t j = 0; j < polygons.size(); j++) {
+		if (flip[j]) { std::reverse(polygons[j].begin(), polygons[j].end()); }
+	}
+	return true;
+}
+
+
+// Emit oriented polygons as a mesh in a single pass, only the used points become vertices
+// Returns false if a face cannot be added (e.g., faces meeting at a single vertex)
+inline bool polygons_to_mesh(Mesh& mesh, const std::vector<Point_3>& points, const std::vector<std::vector<int>>& polygons, bool triangulate = true) {
+	mesh.clear();
+	std::vector<Vertex> vertex_map(points.size(), Mesh::null_vertex());
+	for (auto& polygon : polygons) {
+		std::vector<Vertex> face_vertices;
+		for (auto i : polygon) {
+			if (vertex_map[i] == Mesh::null_vertex()) { vertex_map[i] = mesh.add_vertex(points[i]); }
+			face_vertices.push_back(vertex_map[i]);
+		}
+		if (mesh.add_face(face_vertices) == Mesh::null_face()) { return false; }
+	}
+
+	if (triangulate && !CGAL::is_triangle_mesh(mesh))
+		CGAL::Polygon_mesh_processing::triangulate_faces(mesh);
+	return true;
+}
+
+
+// Assemble surface from selected faces
+// Orientation is propagated directly; the polygon soup repair is the fallback for selections
+// that are not 2-manifold. Without triangulation the planar faces are kept as polygons.
+inline void assemble_surface(Mesh& mesh, std::vector<Point_3>& points, std::vector<std::vector<int>>& polygons, bool triangulate = true) {
+	std::vector<std::vector<int>> oriented = polygons;
+	if (propagate_orientation(points, oriented) && polygons_to_mesh(mesh, points, oriented, triangulate)) { return; }
+
+	std::cout << "Selected faces are not 2-manifold, repairing polygon soup" << std::endl;
+	orient_polygons(mesh, points, polygons, triangulate);
+}
+
+
+// Orient selected candidate faces, which index the scaffold vertices
+void orient(Mesh& mesh, const std::vector<Triple_intersection>& vertices, std::vector<std::vector<int>>& polygons, bool triangulate = true) {
+	// Retrieve mesh points
+	std::vector<Point_3> points;
+	for (auto vertex : vertices) {
+		points.push_back(vertex.point);
+	}
+
+	assemble_surface(mesh, points, polygons, triangulate);
 }
\ No newline at end of file
@@ -0,0 +1,224 @@
+/**
+ * MeshPolygonization is the implementation of the MVS (Multi-view Stereo) building mesh simplification method
+ * described in the following paper:
+ *      Vasileios Bouzas, Hugo Ledoux, and  Liangliang Nan.
+ *      Structure-aware Building Mesh Polygonization.
+ *      ISPRS Journal of Photogrammetry and Remote Sensing. 167(2020), 432-442, 2020.
+ * Please cite the above paper if you use the code/program (or part of it).
+ *
+ * LICENSE:
+ *      MeshPolygonization is free for academic use. If you are interested in a commercial license please contact
+ *      the 3D Geoinformation group.
+ *
+ * Copyright (C) 2019 3D Geoinformation Research Group
+ * https://3d.bk.tudelft.nl/
+ */
+
+#include "ParameterSweep.h"
+#include "Planarity.h"
+#include "PlanarSegmentation.h"
+#include "StructureGraph.h"
+
+#include <chrono>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+
+namespace {
+
+	typedef std::chrono::steady_clock Clock;
+
+	double seconds_since(Clock::time_point t0) {
+		return std::chrono::duration<double>(Clock::now() - t0).count();
+	}
+
+	// Scaffold shared by the face selections of one (rings, distance, importance) combination
+	struct Scaffold {
+		std::vector<Triple_intersection> vertices;
+		std::vector<Plane_intersection> edges;
+		std::vector<Candidate_face> faces;
+		std::size_t num_segments = 0;
+		std::size_t num_planes = 0;
+		double planarity_time = 0.0;
+		double segmentation_time = 0.0;
+		double graph_time = 0.0;
+		double scaffold_time = 0.0;
+	};
+
+}
+
+
+ParameterSweep::ParameterSweep()
+{
+}
+
+
+ParameterSweep::~ParameterSweep()
+{
+}
+
+
+std::vector<Sweep_result> ParameterSweep::run(const Mesh* mesh, const Sweep_parameters& grid, const Regularization_parameters& regularization,
+	                                          const Pruning_parameters& pruning, const Optimization_parameters& optimization,
+	                                          const Output_parameters& output, LinearProgramSolver::SolverName solver_name) {
+	std::size_t num_r = grid.num_rings.size();
+	std::size_t num_d = grid.distance_thresholds.size();
+	std::size_t num_i = grid.importance_thresholds.size();
+	std::size_t num_w = grid.weights.size();
+
+	// One result per combination, in grid order
+	std::vector<Sweep_result> results(num_r * num_d * num_i * num_w);
+	for (std::size_t k = 0; k < results.size(); k++) {
+		Sweep_result& result = results[k];
+		result.weights = grid.weights[k % num_w];
+		result.importance_threshold = grid.importance_thresholds[(k / num_w) % num_i];
+		result.distance_threshold = grid.distance_thresholds[(k / (num_w * num_i)) % num_d];
+		result.num_rings = grid.num_rings[k / (num_w * num_i * num_d)];
+	}
+
+	// Face selection of one combination
+	auto select_faces = [&](std::shared_ptr<const Scaffold> scaffold, std::size_t k) {
+		Sweep_result& result = results[k];
+		Clock::time_point t0 = Clock::now();
+
+		// Pruning modifies the candidates, work on copies
+		std::vector<Triple_intersection> vertices = scaffold->vertices;
+		std::vector<Plane_intersection> edges = scaffold->edges;
+		std::vector<Candidate_face> faces = scaffold->faces;
+
+		Pruning_parameters pruning_params = pruning;
+		pruning_params.max_distance = grid.pruning_distance_ratio * result.distance_threshold;
+		Optimization_parameters optimization_params = optimization;
+		optimization_params.weights = result.weights;
+		optimization_params.report_file.clear();	// the combinations run in parallel, the sweep CSV has their metrics
+
+		Simplification simpl;
+		simpl.set_pruning(pruning_params);
+		simpl.set_optimization(optimization_params);
+		simpl.set_triangulation(output.triangulate);
+		Mesh simplified = simpl.simplify(&vertices, &edges, &faces, solver_name);
+
+		result.selection_time = seconds_since(t0);
+		result.num_segments = scaffold->num_segments;
+		result.num_planes = scaffold->num_planes;
+		result.num_candidates = scaffold->faces.size();
+		result.num_faces = simplified.number_of_faces();
+		result.success = result.num_faces > 0;
+		result.planarity_time = scaffold->planarity_time;
+		result.segmentation_time = scaffold->segmentation_time;
+		result.graph_time = scaffold->graph_time;
+		result.scaffold_time = scaffold->scaffold_time;
+
+		if (result.success && !grid.output_prefix.empty()) {
+			writeSimplified(&simplified, grid.output_prefix + "-" + std::to_string(k) + output_extension(output.format), output.format);
+		}
+	};
+
+#pragma omp parallel
+#pragma omp single
+	for (std::size_t r = 0; r < num_r; r++) {
+#pragma omp task firstprivate(r)
+		{
+			// Planarity
+			Clock::time_point t0 = Clock::now();
+			std::shared_ptr<Mesh> planar_mesh(new Mesh(*mesh));
+			Planarity plan;
+			plan.compute(planar_mesh.get(), grid.num_rings[r]);
+			double planarity_time = seconds_since(t0);
+
+			for (std::size_t d = 0; d < num_d; d++) {
+#pragma omp task firstprivate(r, d, planar_mesh, planarity_time)
+				{
+					// Segmentation
+					Clock::time_point t1 = Clock::now();
+					std::shared_ptr<Mesh> segmented_mesh(new Mesh(*planar_mesh));
+					PlanarSegmentation seg;
+					std::size_t seg_number = seg.apply(segmented_mesh.get(), grid.distance_thresholds[d], grid.num_rings[r]);
+					double segmentation_time = seconds_since(t1);
+
+					for (std::size_t i = 0; i < num_i; i++) {
+#pragma omp task firstprivate(r, d, i, segmented_mesh, seg_number, planarity_time, segmentation_time)
+						{
+							// Structure graph
+							Clock::time_point t2 = Clock::now();
+							Mesh graph_mesh(*segmented_mesh);
+							StructureGraph graph;
+							Graph structure_graph = graph.construct(&graph_mesh, seg_number, grid.importance_thresholds[i]);
+
+							std::shared_ptr<Scaffold> scaffold(new Scaffold);
+							scaffold->num_segments = seg_number;
+							scaffold->num_planes = boost::num_vertices(structure_graph);
+							scaffold->planarity_time = planarity_time;
+							scaffold->segmentation_time = segmentation_time;
+							scaffold->graph_time = seconds_since(t2);
+
+							// Scaffold
+							Clock::time_point t3 = Clock::now();
+							Regularization_parameters regularization_params = regularization;
+							regularization_params.distance_tolerance = grid.regularization_distance_ratio * grid.distance_thresholds[d];
+							Simplification simpl;
+							simpl.set_regularization(regularization_params);
+							std::map<unsigned int, Plane_3> plane_map;
+							simpl.construct_scaffold(&graph_mesh, &structure_graph, &plane_map, &scaffold->vertices, &scaffold->edges, &scaffold->faces);
+							scaffold->scaffold_time = seconds_since(t3);
+
+							// Face selection per weight set
+							std::shared_ptr<const Scaffold> shared_scaffold = scaffold;
+							std::size_t first = ((r * num_d + d) * num_i + i) * num_w;
+							for (std::size_t w = 0; w < num_w; w++) {
+#pragma omp task firstprivate(shared_scaffold, first, w)
+								select_faces(shared_scaffold, first + w);
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	return results;
+}
+
+
+void ParameterSweep::report(const std::vector<Sweep_result>* results, const std::string& file) {
+	// Table
+	std::cout << "----------------------------------------------------------------" << std::endl;
+	std::cout << "Parameter sweep: " << results->size() << " combinations" << std::endl;
+	std::cout << std::setw(4) << "#" << std::setw(7) << "rings" << std::setw(10) << "distance" << std::setw(12) << "importance"
+		      << std::setw(20) << "weights" << std::setw(10) << "segments" << std::setw(8) << "planes" << std::setw(12) << "candidates"
+		      << std::setw(8) << "faces" << std::setw(14) << "select (s)" << std::setw(13) << "total (s)" << std::endl;
+	for (std::size_t k = 0; k < results->size(); k++) {
+		const Sweep_result& result = (*results)[k];
+		std::ostringstream weights;
+		weights << std::setprecision(3) << result.weights.fitting << "/" << result.weights.coverage << "/" << result.weights.complexity;
+		double total = result.planarity_time + result.segmentation_time + result.graph_time + result.scaffold_time + result.selection_time;
+		std::cout << std::setw(4) << k << std::setw(7) << result.num_rings << std::setw(10) << result.distance_threshold
+			      << std::setw(12) << result.importance_threshold << std::setw(20) << weights.str() << std::setw(10) << result.num_segments
+			      << std::setw(8) << result.num_planes << std::setw(12) << result.num_candidates
+			      << std::setw(8) << (result.success ? std::to_string(result.num_faces) : std::string("failed"))
+			      << std::setw(14) << std::fixed << std::setprecision(2) << result.selection_time
+			      << std::setw(13) << total << std::defaultfloat << std::endl;
+	}
+
+	if (file.empty()) { return; }
+
+	// CSV
+	std::ofstream output(file.c_str());
+	if (output.fail()) {
+		std::cerr << "Failed to create file \'" << file << "\'" << std::endl;
+		return;
+	}
+	output << "index,num_rings,distance_threshold,importance_threshold,wt_fitting,wt_coverage,wt_complexity,"
+		   << "segments,planes,candidates,faces,success,planarity_time,segmentation_time,graph_time,scaffold_time,selection_time" << std::endl;
+	for (std::size_t k = 0; k < results->size(); k++) {
+		const Sweep_result& result = (*results)[k];
+		output << k << "," << result.num_rings << "," << result.distance_threshold << "," << result.importance_threshold << ","
+			   << result.weights.fitting << "," << result.weights.coverage << "," << result.weights.complexity << ","
+			   << result.num_segments << "," << result.num_planes << "," << result.num_candidates << "," << result.num_faces << ","
+			   << (result.success ? 1 : 0) << "," << result.planarity_time << "," << result.segmentation_time << ","
+			   << result.graph_time << "," << result.scaffold_time << "," << result.selection_time << std::endl;
+	}
+	std::cout << "Sweep results saved to file \'" << file << "\'" << std::endl;
+}
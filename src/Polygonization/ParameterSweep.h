@@ -0,0 +1,90 @@
+/**
+ * MeshPolygonization is the implementation of the MVS (Multi-view Stereo) building mesh simplification method
+ * described in the following paper:
+ *      Vasileios Bouzas, Hugo Ledoux, and  Liangliang Nan.
+ *      Structure-aware Building Mesh Polygonization.
+ *      ISPRS Journal of Photogrammetry and Remote Sensing. 167(2020), 432-442, 2020.
+ * Please cite the above paper if you use the code/program (or part of it).
+ *
+ * LICENSE:
+ *      MeshPolygonization is free for academic use. If you are interested in a commercial license please contact
+ *      the 3D Geoinformation group.
+ *
+ * Copyright (C) 2019 3D Geoinformation Research Group
+ * https://3d.bk.tudelft.nl/
+ */
+
+#pragma once
+
+#include "Utils.h"
+#include "Simplification.h"
+#include "FileWritter.h"
+
+
+// SWEEP PARAMETERS //
+// Parameter grids, every combination is evaluated
+struct Sweep_parameters {
+	// Order of k-ring neighborhood (planarity)
+	std::vector<unsigned int> num_rings = { 3 };
+
+	// Distance thresholds (segmentation)
+	std::vector<double> distance_thresholds = { 0.8 };
+
+	// Importance thresholds (structure graph)
+	std::vector<double> importance_thresholds = { 0.0 };
+
+	// Objective weights (face selection)
+	std::vector<Objective_weights> weights = { Objective_weights() };
+
+	// Regularization offset and pruning distance, relative to the distance threshold
+	double regularization_distance_ratio = 0.5;
+	double pruning_distance_ratio = 1.0;
+
+	// Write the result of combination i to <output_prefix>-<i> (empty to disable)
+	std::string output_prefix;
+};
+// SWEEP PARAMETERS //
+
+
+// SWEEP RESULT //
+struct Sweep_result {
+	// Parameters
+	unsigned int num_rings = 0;
+	double distance_threshold = 0.0;
+	double importance_threshold = 0.0;
+	Objective_weights weights;
+
+	// Metrics
+	std::size_t num_segments = 0;
+	std::size_t num_planes = 0;
+	std::size_t num_candidates = 0;
+	std::size_t num_faces = 0;
+	bool success = false;
+
+	// Stage times (secs), the first four stages are shared with other combinations
+	double planarity_time = 0.0;
+	double segmentation_time = 0.0;
+	double graph_time = 0.0;
+	double scaffold_time = 0.0;
+	double selection_time = 0.0;
+};
+// SWEEP RESULT //
+
+
+// Parameter sweep
+// Stages form a tree: planarity once per number of rings, segmentation once per (rings, distance),
+// structure graph and scaffold once per importance, and only the face selection once per weight set.
+// Independent branches run as parallel tasks, each on its own copy of the mesh.
+class ParameterSweep
+{
+public:
+	ParameterSweep();
+	~ParameterSweep();
+
+	std::vector<Sweep_result> run(const Mesh* mesh, const Sweep_parameters& grid, const Regularization_parameters& regularization,
+		                          const Pruning_parameters& pruning, const Optimization_parameters& optimization,
+		                          const Output_parameters& output, LinearProgramSolver::SolverName solver_name);
+
+	// Print results as a table, and write them as CSV (if file is not empty)
+	static void report(const std::vector<Sweep_result>* results, const std::string& file);
+};
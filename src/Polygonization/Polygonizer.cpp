@@ -0,0 +1,153 @@
+/**
+ * MeshPolygonization is the implementation of the MVS (Multi-view Stereo) building mesh simplification method
+ * described in the following paper:
+ *      Vasileios Bouzas, Hugo Ledoux, and  Liangliang Nan.
+ *      Structure-aware Building Mesh Polygonization.
+ *      ISPRS Journal of Photogrammetry and Remote Sensing. 167(2020), 432-442, 2020.
+ * Please cite the above paper if you use the code/program (or part of it).
+ *
+ * LICENSE:
+ *      MeshPolygonization is free for academic use. If you are interested in a commercial license please contact
+ *      the 3D Geoinformation group.
+ *
+ * Copyright (C) 2019 3D Geoinformation Research Group
+ * https://3d.bk.tudelft.nl/
+ */
+
+#include "Polygonizer.h"
+#include "Planarity.h"
+#include "PlanarSegmentation.h"
+#include "StructureGraph.h"
+#include "Simplification.h"
+#include "StageCache.h"
+
+#include <chrono>
+#include <memory>
+#include <iomanip>
+
+
+namespace {
+
+	typedef std::chrono::steady_clock Clock;
+
+	double seconds_since(Clock::time_point t0) {
+		return std::chrono::duration<double>(Clock::now() - t0).count();
+	}
+
+	void print_time(const char* stage, double secs, bool cached) {
+		std::cout << stage << ": " << std::setprecision(1) << std::fixed << secs << " secs" << (cached ? " (cached)" : "")
+			      << std::defaultfloat << std::endl;
+	}
+
+}
+
+
+Polygonizer::Polygonizer(const PolygonizerConfig& config)
+	: config_(config)
+{
+}
+
+
+Polygonizer::~Polygonizer()
+{
+}
+
+
+PolygonizerResult Polygonizer::apply(Mesh* mesh, const Stage_callback& callback) const {
+	PolygonizerResult result;
+	PolygonizerStats& stats = result.stats;
+
+	auto stage_done = [&](const char* name, const char* stage, double secs, bool cached) {
+		if (config_.verbose) { print_time(name, secs, cached); }
+		if (callback) { callback(stage, secs, cached); }
+	};
+
+	// Stage cache: keys chain the input mesh with the parameters of each stage,
+	// the longest prefix of cached stages is reused
+	std::unique_ptr<StageCache> stage_cache;
+	if (!config_.stage_cache_directory.empty()) { stage_cache.reset(new StageCache(config_.stage_cache_directory)); }
+	const Regularization_parameters& regularization = config_.regularization;
+	std::uint64_t planarity_key = stage_cache ? StageCache::combine(StageCache::hash_mesh(mesh), config_.num_rings) : 0;
+	std::uint64_t segmentation_key = StageCache::combine(planarity_key, config_.dist_threshold);
+	std::uint64_t graph_key = StageCache::combine(segmentation_key, config_.importance_threshold);
+	std::uint64_t scaffold_key = StageCache::combine(StageCache::combine(StageCache::combine(graph_key,
+		regularization.enabled), regularization.angle_tolerance), regularization.distance_tolerance);
+	bool cached = (stage_cache != nullptr);
+
+	// Planarity
+	Clock::time_point t0 = Clock::now();
+	cached = cached && stage_cache->load_planarity(planarity_key, mesh);
+	if (!cached) {
+		Planarity plan;
+		plan.compute(mesh, config_.num_rings);
+		if (stage_cache) { stage_cache->store_planarity(planarity_key, mesh); }
+	}
+	stats.planarity_time = seconds_since(t0);
+	stats.planarity_cached = cached;
+	stage_done("Planarity", "planarity", stats.planarity_time, cached);
+
+	// Segmentation
+	t0 = Clock::now();
+	std::size_t seg_number = 0;
+	cached = cached && stage_cache->load_segmentation(segmentation_key, mesh, &seg_number);
+	if (!cached) {
+		PlanarSegmentation seg;
+		seg_number = seg.apply(mesh, config_.dist_threshold, config_.num_rings);
+		if (stage_cache) { stage_cache->store_segmentation(segmentation_key, mesh, seg_number); }
+	}
+	stats.segmentation_time = seconds_since(t0);
+	stats.segmentation_cached = cached;
+	stats.num_segments = seg_number;
+	stage_done("Segmentation", "segmentation", stats.segmentation_time, cached);
+
+	// Structure graph
+	t0 = Clock::now();
+	Graph structure_graph;
+	cached = cached && stage_cache->load_structure_graph(graph_key, mesh, &structure_graph);
+	if (!cached) {
+		StructureGraph graph;
+		structure_graph = graph.construct(mesh, seg_number, config_.importance_threshold);
+		if (stage_cache) { stage_cache->store_structure_graph(graph_key, mesh, &structure_graph); }
+	}
+	stats.graph_time = seconds_since(t0);
+	stats.graph_cached = cached;
+	stats.num_planes = boost::num_vertices(structure_graph);
+	stage_done("Structure Graph", "structure_graph", stats.graph_time, cached);
+
+	Simplification simpl;
+	simpl.set_regularization(config_.regularization);
+	simpl.set_pruning(config_.pruning);
+	Optimization_parameters optimization = config_.optimization;
+	optimization.verbose = optimization.verbose && config_.verbose;
+	simpl.set_optimization(optimization);
+	simpl.set_triangulation(config_.triangulate);
+	simpl.set_verbose(config_.verbose);
+	if (!config_.program_export.empty()) { simpl.set_program_export(config_.program_export); }
+
+	// Scaffold, reused only when the earlier stages were reused as well
+	t0 = Clock::now();
+	std::map<unsigned int, Plane_3> plane_map;
+	std::vector<Triple_intersection> vertices;
+	std::vector<Plane_intersection> edges;
+	std::vector<Candidate_face> faces;
+	cached = cached && stage_cache->load_scaffold(scaffold_key, &plane_map, &vertices, &edges, &faces);
+	if (!cached) {
+		simpl.construct_scaffold(mesh, &structure_graph, &plane_map, &vertices, &edges, &faces);
+		if (stage_cache) { stage_cache->store_scaffold(scaffold_key, &plane_map, &vertices, &edges, &faces); }
+	}
+	stats.scaffold_time = seconds_since(t0);
+	stats.scaffold_cached = cached;
+	stats.num_candidates = faces.size();
+	stage_done("Scaffold", "scaffold", stats.scaffold_time, cached);
+
+	// Face selection
+	t0 = Clock::now();
+	result.mesh = simpl.simplify(&vertices, &edges, &faces, config_.solver);
+	result.program_exported = simpl.program_exported();
+	stats.selection_time = seconds_since(t0);
+	stats.num_faces = result.mesh.number_of_faces();
+	stage_done("Face selection", "face_selection", stats.selection_time, false);
+
+	result.success = stats.num_faces > 0;
+	return result;
+}
@@ -0,0 +1,124 @@
+/**
+ * MeshPolygonization is the implementation of the MVS (Multi-view Stereo) building mesh simplification method
+ * described in the following paper:
+ *      Vasileios Bouzas, Hugo Ledoux, and  Liangliang Nan.
+ *      Structure-aware Building Mesh Polygonization.
+ *      ISPRS Journal of Photogrammetry and Remote Sensing. 167(2020), 432-442, 2020.
+ * Please cite the above paper if you use the code/program (or part of it).
+ *
+ * LICENSE:
+ *      MeshPolygonization is free for academic use. If you are interested in a commercial license please contact
+ *      the 3D Geoinformation group.
+ *
+ * Copyright (C) 2019 3D Geoinformation Research Group
+ * https://3d.bk.tudelft.nl/
+ */
+
+#pragma once
+
+#include "Utils.h"
+#include "Regularization.h"
+#include "Pruning.h"
+#include "Optimization.h"
+#include "solver/linear_program_solver.h"
+
+#include <functional>
+
+
+// POLYGONIZER CONFIG //
+struct PolygonizerConfig {
+	// Order of k-ring neighborhood (planarity)
+	unsigned int num_rings = 3;
+
+	// Distance threshold (segmentation), see set_distance_threshold()
+	double dist_threshold = 0.8;
+
+	// Importance threshold (structure graph)
+	double importance_threshold = 0.0;
+
+	// Scaffold and face selection
+	Regularization_parameters regularization;
+	Pruning_parameters pruning;
+	Optimization_parameters optimization;
+	LinearProgramSolver::SolverName solver = LinearProgramSolver::GUROBI;
+
+	// Triangulate the selected faces, otherwise the result keeps the planar polygons
+	bool triangulate = true;
+
+	// Stage cache directory (empty to disable)
+	std::string stage_cache_directory;
+
+	// Stop after building the face selection program and write it to <program_export>.mps/.lp (empty to disable)
+	std::string program_export;
+
+	// Print the stage times, and the scaffold, optimization and solver summaries
+	bool verbose = true;
+
+	PolygonizerConfig() { set_distance_threshold(dist_threshold); }
+
+	// Distance threshold, with the regularization offset and pruning distance that scale with it
+	void set_distance_threshold(double d) {
+		dist_threshold = d;
+		regularization.distance_tolerance = 0.5 * d;
+		pruning.max_distance = d;
+	}
+};
+// POLYGONIZER CONFIG //
+
+
+// POLYGONIZER STATS //
+struct PolygonizerStats {
+	std::size_t num_segments = 0;
+	std::size_t num_planes = 0;
+	std::size_t num_candidates = 0;
+	std::size_t num_faces = 0;
+
+	// Stage times (secs)
+	double planarity_time = 0.0;
+	double segmentation_time = 0.0;
+	double graph_time = 0.0;
+	double scaffold_time = 0.0;
+	double selection_time = 0.0;
+
+	// Stages loaded from the stage cache
+	bool planarity_cached = false;
+	bool segmentation_cached = false;
+	bool graph_cached = false;
+	bool scaffold_cached = false;
+};
+// POLYGONIZER STATS //
+
+
+// POLYGONIZER RESULT //
+struct PolygonizerResult {
+	// Simplified mesh (empty on failure or when the program was exported)
+	Mesh mesh;
+	PolygonizerStats stats;
+	bool success = false;
+
+	// The program and the candidate faces were written (config.program_export only)
+	bool program_exported = false;
+};
+// POLYGONIZER RESULT //
+
+
+// Complete pipeline: planarity, segmentation, structure graph, scaffold and face selection
+// Works on an in-memory mesh, so that it can be called in-process without file round-trips.
+class Polygonizer
+{
+public:
+	// Called after each stage with its name (planarity, segmentation, structure_graph, scaffold or face_selection),
+	// time (secs) and whether it was loaded from the stage cache
+	typedef std::function<void(const std::string& stage, double seconds, bool cached)> Stage_callback;
+
+	Polygonizer(const PolygonizerConfig& config);
+	~Polygonizer();
+
+	const PolygonizerConfig& config() const { return config_; }
+
+	// The stage properties (planarity, segmentation, importance) are added to mesh
+	PolygonizerResult apply(Mesh* mesh, const Stage_callback& callback = Stage_callback()) const;
+
+private:
+	PolygonizerConfig config_;
+};
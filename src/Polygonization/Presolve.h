@@ -0,0 +1,217 @@
+/**
+ * MeshPolygonization is the implementation of the MVS (Multi-view Stereo) building mesh simplification method
+ * described in the following paper:
+ *      Vasileios Bouzas, Hugo Ledoux, and  Liangliang Nan.
+ *      Structure-aware Building Mesh Polygonization.
+ *      ISPRS Journal of Photogrammetry and Remote Sensing. 167(2020), 432-442, 2020.
+ * Please cite the above paper if you use the code/program (or part of it).
+ *
+ * LICENSE:
+ *      MeshPolygonization is free for academic use. If you are interested in a commercial license please contact
+ *      the 3D Geoinformation group.
+ *
+ * Copyright (C) 2019 3D Geoinformation Research Group
+ * https://3d.bk.tudelft.nl/
+ */
+
+#pragma once
+
+#include <vector>
+#include <map>
+#include <set>
+#include <algorithm>
+
+
+// PRESOLVED PROGRAM //
+// Face selection program after presolve:
+// each kept fan states that its number of selected faces is either 0 or 2
+struct Presolved_program {
+	// Reduced variable of each original face (-1 if fixed)
+	std::vector<int> face_variables;
+
+	// Value of each fixed original face
+	std::vector<double> fixed_values;
+
+	// Original face of each reduced face variable
+	std::vector<std::size_t> faces;
+
+	// Objective coefficient of each reduced face variable
+	std::vector<double> costs;
+
+	// Kept fans (reduced face variables), one constraint each
+	std::vector<std::vector<std::size_t>> fans;
+
+	// Original edges sharing each kept fan
+	std::vector<std::vector<std::size_t>> edges;
+};
+// PRESOLVED PROGRAM //
+
+
+// Presolve face selection program
+// - Fan of a single live face: the face is forced to 0 (propagated)
+// - Empty fans: dropped
+// - Faces without fans: fixed by the sign of their cost
+// - Duplicate fans: share one constraint and one "edge used" variable
+inline Presolved_program presolve_fans(const std::vector<double>* costs, const std::vector<std::vector<std::size_t>>* fans) {
+	Presolved_program presolved;
+	std::size_t num_faces = costs->size();
+	std::size_t num_edges = fans->size();
+
+	// Unique faces of each fan
+	std::vector<std::vector<std::size_t>> unique_fans(num_edges);
+	std::vector<std::vector<std::size_t>> face_edges(num_faces);
+	for (std::size_t i = 0; i < num_edges; i++) {
+		std::set<std::size_t> fan((*fans)[i].begin(), (*fans)[i].end());
+		unique_fans[i].assign(fan.begin(), fan.end());
+		for (auto f : fan) { face_edges[f].push_back(i); }
+	}
+
+	// Fix forced faces
+	std::vector<bool> alive(num_faces, true);
+	std::vector<std::size_t> live_count(num_edges);
+	std::vector<std::size_t> queue;
+	for (std::size_t i = 0; i < num_edges; i++) {
+		live_count[i] = unique_fans[i].size();
+		if (live_count[i] == 1) { queue.push_back(i); }
+	}
+
+	while (!queue.empty()) {
+		std::size_t e = queue.back();
+		queue.pop_back();
+		if (live_count[e] != 1) { continue; }
+
+		for (auto f : unique_fans[e]) {
+			if (!alive[f]) { continue; }
+
+			alive[f] = false;
+			for (auto adj : face_edges[f]) {
+				if (--live_count[adj] == 1) { queue.push_back(adj); }
+			}
+			break;
+		}
+	}
+
+	// Renumber live faces
+	presolved.face_variables.assign(num_faces, -1);
+	presolved.fixed_values.assign(num_faces, 0.0);
+	for (std::size_t f = 0; f < num_faces; f++) {
+		if (!alive[f]) { continue; }
+
+		// Faces without constraints only depend on their cost
+		bool constrained = false;
+		for (auto e : face_edges[f]) {
+			if (live_count[e] >= 2) { constrained = true; break; }
+		}
+		if (!constrained) {
+			presolved.fixed_values[f] = ((*costs)[f] < 0.0) ? 1.0 : 0.0;
+			continue;
+		}
+
+		presolved.face_variables[f] = int(presolved.faces.size());
+		presolved.faces.push_back(f);
+		presolved.costs.push_back((*costs)[f]);
+	}
+
+	// Keep fans with live faces, merging duplicates
+	std::map<std::vector<std::size_t>, std::size_t> fan_map;
+	for (std::size_t i = 0; i < num_edges; i++) {
+		if (live_count[i] < 2) { continue; }
+
+		std::vector<std::size_t> fan;
+		for (auto f : unique_fans[i]) {
+			if (alive[f]) { fan.push_back(std::size_t(presolved.face_variables[f])); }
+		}
+
+		auto pos = fan_map.find(fan);
+		if (pos != fan_map.end()) {
+			presolved.edges[pos->second].push_back(i);
+			continue;
+		}
+
+		fan_map[fan] = presolved.fans.size();
+		presolved.fans.push_back(fan);
+		presolved.edges.push_back(std::vector<std::size_t>(1, i));
+	}
+
+	return presolved;
+}
+
+
+// Map reduced solution back to all faces and edges
+// Layout: x[0] ... x[num_faces - 1] : faces, x[num_faces] ... x[num_faces + num_edges - 1] : edges used
+inline std::vector<double> postsolve_fans(const Presolved_program* presolved, const std::vector<double>* solution, std::size_t num_edges) {
+	std::size_t num_faces = presolved->face_variables.size();
+	std::size_t num_variables = presolved->faces.size();
+	std::vector<double> X(num_faces + num_edges, 0.0);
+
+	// Faces
+	for (std::size_t f = 0; f < num_faces; f++) {
+		int var = presolved->face_variables[f];
+		X[f] = (var < 0) ? presolved->fixed_values[f] : (*solution)[var];
+	}
+
+	// Edges used
+	for (std::size_t k = 0; k < presolved->fans.size(); k++) {
+		for (auto e : presolved->edges[k]) {
+			X[num_faces + e] = (*solution)[num_variables + k];
+		}
+	}
+
+	return X;
+}
+
+
+// FAN COMPONENT //
+// Connected component of the face/fan incidence graph
+struct Fan_component {
+	// Reduced face variables
+	std::vector<std::size_t> faces;
+
+	// Kept fans
+	std::vector<std::size_t> fans;
+};
+// FAN COMPONENT //
+
+
+// Split presolved program into independent components
+// local_faces receives the position of each reduced face in its component
+inline std::vector<Fan_component> split_components(const Presolved_program* presolved, std::vector<std::size_t>* local_faces) {
+	std::size_t num_faces = presolved->faces.size();
+
+	// Union faces sharing a fan
+	std::vector<std::size_t> parent(num_faces);
+	for (std::size_t f = 0; f < num_faces; f++) { parent[f] = f; }
+	auto find_root = [&](std::size_t f) {
+		while (parent[f] != f) { parent[f] = parent[parent[f]]; f = parent[f]; }
+		return f;
+	};
+	for (auto& fan : presolved->fans) {
+		std::size_t root = find_root(fan[0]);
+		for (auto f : fan) { parent[find_root(f)] = root; }
+	}
+
+	// Collect components
+	std::vector<Fan_component> components;
+	std::vector<int> component_of(num_faces, -1);
+	local_faces->assign(num_faces, 0);
+	for (std::size_t f = 0; f < num_faces; f++) {
+		std::size_t root = find_root(f);
+		if (component_of[root] < 0) {
+			component_of[root] = int(components.size());
+			components.push_back(Fan_component());
+		}
+		Fan_component& component = components[component_of[root]];
+		(*local_faces)[f] = component.faces.size();
+		component.faces.push_back(f);
+	}
+	for (std::size_t k = 0; k < presolved->fans.size(); k++) {
+		components[component_of[find_root(presolved->fans[k][0])]].fans.push_back(k);
+	}
+
+	// Largest components first
+	std::sort(components.begin(), components.end(),
+		      [](const Fan_component &a, const Fan_component &b)
+	          {return a.faces.size() > b.faces.size(); });
+
+	return components;
+}
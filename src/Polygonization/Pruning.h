@@ -0,0 +1,107 @@
+/**
+ * MeshPolygonization is the implementation of the MVS (Multi-view Stereo) building mesh simplification method
+ * described in the following paper:
+ *      Vasileios Bouzas, Hugo Ledoux, and  Liangliang Nan.
+ *      Structure-aware Building Mesh Polygonization.
+ *      ISPRS Journal of Photogrammetry and Remote Sensing. 167(2020), 432-442, 2020.
+ * Please cite the above paper if you use the code/program (or part of it).
+ *
+ * LICENSE:
+ *      MeshPolygonization is free for academic use. If you are interested in a commercial license please contact
+ *      the 3D Geoinformation group.
+ *
+ * Copyright (C) 2019 3D Geoinformation Research Group
+ * https://3d.bk.tudelft.nl/
+ */
+
+#pragma once
+
+#include "Utils.h"
+#include "CandidateFace.h"
+
+
+// PRUNING PARAMETERS //
+// A face is hopeless if it fails all three criteria
+struct Pruning_parameters {
+	// Enable pruning stage (off by default: unsupported closing faces, e.g. the ground, may be pruned)
+	bool enabled = false;
+
+	// Minimum ratio of covered area to total area
+	double min_coverage = 0.01;
+
+	// Minimum number of supporting faces
+	std::size_t min_support = 1;
+
+	// Maximum distance to supporting data
+	double max_distance = 0.0;
+};
+// PRUNING PARAMETERS //
+
+
+// Check if face will never be chosen
+inline bool is_hopeless(const Candidate_face* face, const Pruning_parameters& params) {
+	double coverage = (face->area > 0.0) ? face->covered_area / face->area : 0.0;
+
+	return coverage < params.min_coverage &&
+		   face->supporting_face_num < params.min_support &&
+		   face->data_distance > params.max_distance;
+}
+
+
+// Prune candidate faces
+// Hopeless faces are fixed to 0 and propagated through the edge fans:
+// an edge left with a single live face forces that face to 0 as well.
+inline std::size_t prune_candidate_faces(std::vector<Candidate_face>* faces, std::vector<Plane_intersection>* edges, const Pruning_parameters& params) {
+	// Count live faces of each edge
+	std::vector<bool> alive(faces->size(), true);
+	std::vector<std::size_t> live_count(edges->size());
+	for (std::size_t i = 0; i < edges->size(); i++) {
+		live_count[i] = (*edges)[i].faces.size();
+	}
+
+	// Kill face and collect edges left with one live face
+	std::vector<int> queue;
+	auto kill = [&](int j) {
+		alive[j] = false;
+		std::set<int> face_edges((*faces)[j].edges.begin(), (*faces)[j].edges.end());
+		for (auto e : face_edges) {
+			if (--live_count[e] == 1) { queue.push_back(e); }
+		}
+	};
+
+	// Fix hopeless faces
+	for (std::size_t j = 0; j < faces->size(); j++) {
+		if (is_hopeless(&(*faces)[j], params)) { kill(int(j)); }
+	}
+
+	// Initial fans with a single face
+	for (std::size_t i = 0; i < edges->size(); i++) {
+		if ((*edges)[i].faces.size() == 1) { queue.push_back(int(i)); }
+	}
+
+	// Propagate through edge fans
+	while (!queue.empty()) {
+		int e = queue.back();
+		queue.pop_back();
+		if (live_count[e] != 1) { continue; }
+
+		for (auto j : (*edges)[e].faces) {
+			if (alive[j]) { kill(j); break; }
+		}
+	}
+
+	// Keep surviving faces
+	std::vector<Candidate_face> surviving;
+	for (std::size_t j = 0; j < faces->size(); j++) {
+		if (alive[j]) { surviving.push_back((*faces)[j]); }
+	}
+
+	std::size_t removed = faces->size() - surviving.size();
+	faces->swap(surviving);
+
+	// Update edges
+	update_edge_faces(faces, edges);
+	remove_unused_edges(faces, edges);
+
+	return removed;
+}
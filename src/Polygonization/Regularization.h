@@ -0,0 +1,272 @@
+/**
+ * MeshPolygonization is the implementation of the MVS (Multi-view Stereo) building mesh simplification method
+ * described in the following paper:
+ *      Vasileios Bouzas, Hugo Ledoux, and  Liangliang Nan.
+ *      Structure-aware Building Mesh Polygonization.
+ *      ISPRS Journal of Photogrammetry and Remote Sensing. 167(2020), 432-442, 2020.
+ * Please cite the above paper if you use the code/program (or part of it).
+ *
+ * LICENSE:
+ *      MeshPolygonization is free for academic use. If you are interested in a commercial license please contact
+ *      the 3D Geoinformation group.
+ *
+ * Copyright (C) 2019 3D Geoinformation Research Group
+ * https://3d.bk.tudelft.nl/
+ */
+
+#pragma once
+
+#include "Utils.h"
+#include "Segment.h"
+
+
+// REGULARIZATION PARAMETERS //
+struct Regularization_parameters {
+	// Enable regularization stage
+	bool enabled = false;
+
+	// Maximum angle (degrees) for parallel, orthogonal and horizontal snapping
+	double angle_tolerance = 3.0;
+
+	// Maximum offset between parallel planes to be considered coplanar
+	double distance_tolerance = 0.1;
+};
+// REGULARIZATION PARAMETERS //
+
+
+// Normalize vector
+inline Vector_3 normalize_vector(const Vector_3& v) {
+	double length = std::sqrt(v.squared_length());
+	if (length < 1e-12) { return v; }
+	return v / length;
+}
+
+
+// Group plane normals into parallel orientation clusters
+// Cluster 0 is the vertical direction, so that near-horizontal planes snap to it
+inline std::vector<int> cluster_orientations(const std::vector<Vector_3>* normals, const std::vector<double>* weights,
+	                                         double cos_tol, std::vector<Vector_3>* directions) {
+	std::vector<int> clusters(normals->size(), -1);
+	std::vector<Vector_3> sums;
+
+	// Fixed vertical direction
+	directions->push_back(Vector_3(0, 0, 1));
+	sums.push_back(Vector_3(0, 0, 0));
+
+	// Visit heavier planes first
+	std::vector<std::size_t> order(normals->size());
+	for (std::size_t i = 0; i < order.size(); i++) { order[i] = i; }
+	std::sort(order.begin(), order.end(),
+		      [&](const std::size_t &a, const std::size_t &b)
+	          {return (*weights)[a] > (*weights)[b]; });
+
+	for (auto i : order) {
+		Vector_3 n = (*normals)[i];
+
+		// Find closest orientation (sign independent)
+		int best = -1;
+		double best_cos = cos_tol;
+		for (std::size_t c = 0; c < directions->size(); c++) {
+			double c_angle = std::abs(n * (*directions)[c]);
+			if (c_angle >= best_cos) { best_cos = c_angle; best = int(c); }
+		}
+
+		// New orientation
+		if (best == -1) {
+			directions->push_back(n);
+			sums.push_back(n * (*weights)[i]);
+			clusters[i] = int(directions->size()) - 1;
+			continue;
+		}
+
+		// Join orientation, aligning sign with cluster direction
+		clusters[i] = best;
+		if (best == 0) { continue; } // Vertical direction stays fixed
+		if (n * (*directions)[best] < 0) { n = -n; }
+		sums[best] = sums[best] + n * (*weights)[i];
+		(*directions)[best] = normalize_vector(sums[best]);
+	}
+
+	return clusters;
+}
+
+
+// Snap near-orthogonal orientations to exact orthogonality
+// Returns the orientation each cluster was merged into
+inline std::vector<int> snap_orthogonal(std::vector<Vector_3>* directions, const std::vector<double>* cluster_weights, double cos_tol) {
+	double sin_tol = std::sqrt(1.0 - cos_tol * cos_tol);
+	std::vector<int> merged(directions->size());
+	for (std::size_t c = 0; c < merged.size(); c++) { merged[c] = int(c); }
+
+	// Visit heavier orientations first, the vertical direction is the first reference
+	std::vector<std::size_t> order;
+	for (std::size_t c = 1; c < directions->size(); c++) { order.push_back(c); }
+	std::sort(order.begin(), order.end(),
+		      [&](const std::size_t &a, const std::size_t &b)
+	          {return (*cluster_weights)[a] > (*cluster_weights)[b]; });
+
+	std::vector<std::size_t> references;
+	references.push_back(0);
+	for (auto c : order) {
+		Vector_3 d = (*directions)[c];
+
+		// Collect near-orthogonal references
+		std::vector<std::size_t> orthogonal;
+		for (auto r : references) {
+			if (std::abs(d * (*directions)[r]) < sin_tol) { orthogonal.push_back(r); }
+		}
+
+		if (!orthogonal.empty()) {
+			// Project to the plane orthogonal to the first reference
+			Vector_3 d1 = (*directions)[orthogonal[0]];
+			Vector_3 snapped = normalize_vector(d - (d * d1) * d1);
+
+			// Snap to the cross product, if orthogonal to a second reference as well
+			for (std::size_t k = 1; k < orthogonal.size(); k++) {
+				Vector_3 d2 = (*directions)[orthogonal[k]];
+				if (std::abs(d1 * d2) > 1e-9 || std::abs(snapped * d2) >= sin_tol) { continue; }
+
+				Vector_3 cross = normalize_vector(CGAL::cross_product(d1, d2));
+				if (cross * d < 0) { cross = -cross; }
+				snapped = cross; break;
+			}
+			d = snapped;
+		}
+
+		// Merge with a reference that has become parallel
+		bool is_merged = false;
+		for (auto r : references) {
+			if (std::abs(d * (*directions)[r]) > cos_tol) {
+				merged[c] = int(r);
+				is_merged = true; break;
+			}
+		}
+
+		(*directions)[c] = d;
+		if (!is_merged) { references.push_back(c); }
+	}
+
+	return merged;
+}
+
+
+// Merge segments into a representative segment
+inline void merge_coplanar_segments(Mesh* mesh, Graph* G, std::map<unsigned int, unsigned int>* representatives) {
+	FProp_int chart = mesh->property_map<Face, int>("f:chart").value();
+	FProp_color color = mesh->property_map<Face, Point_3>("f:color").value();
+
+	// Relabel absorbed segments
+	for (auto pair : *representatives) {
+		if (pair.first == pair.second) { continue; }
+
+		Point_3 rep_color = get_segment_color(mesh, pair.second);
+		for (auto face : select_segment(mesh, pair.first)) {
+			chart[face] = pair.second;
+			color[face] = rep_color;
+		}
+	}
+
+	// Reconstruct structure graph
+	Graph H;
+	std::map<unsigned int, Graph_vertex> vertex_map;
+	Graph_vertex_iterator vb, ve;
+	for (boost::tie(vb, ve) = vertices(*G); vb != ve; ++vb) {
+		unsigned int id = (*G)[*vb].segment;
+		if ((*representatives)[id] != id) { continue; }
+		vertex_map[id] = boost::add_vertex(GraphVertex{id}, H);
+	}
+
+	Graph_edge_iterator eb, ee;
+	for (boost::tie(eb, ee) = edges(*G); eb != ee; ++eb) {
+		unsigned int s = (*representatives)[(*G)[boost::source(*eb, *G)].segment];
+		unsigned int t = (*representatives)[(*G)[boost::target(*eb, *G)].segment];
+		if (s != t) { boost::add_edge(vertex_map[s], vertex_map[t], H); }
+	}
+
+	*G = H;
+}
+
+
+// Regularize supporting planes
+// Snaps near-parallel, near-orthogonal and near-horizontal planes to shared orientations
+// and merges coplanar segments. Returns the number of remaining planes.
+inline std::size_t regularize_planes(Mesh* mesh, Graph* G, std::map<unsigned int, Plane_3>* plane_map, const Regularization_parameters& params) {
+	double cos_tol = std::cos(params.angle_tolerance * CGAL_PI / 180.0);
+
+	// Collect plane attributes
+	std::vector<unsigned int> ids;
+	std::vector<Vector_3> normals;
+	std::vector<Point_3> centroids;
+	std::vector<double> weights;
+	Graph_vertex_iterator vb, ve;
+	for (boost::tie(vb, ve) = vertices(*G); vb != ve; ++vb) {
+		unsigned int id = (*G)[*vb].segment;
+		ids.push_back(id);
+		normals.push_back(normalize_vector((*plane_map)[id].orthogonal_vector()));
+		centroids.push_back(get_segment_centroid(mesh, id));
+		weights.push_back(double(select_segment(mesh, id).size()));
+	}
+	if (ids.empty()) { return 0; }
+
+	// Parallel orientation clusters
+	std::vector<Vector_3> directions;
+	std::vector<int> clusters = cluster_orientations(&normals, &weights, cos_tol, &directions);
+
+	// Orthogonal snapping
+	std::vector<double> cluster_weights(directions.size(), 0.0);
+	for (std::size_t i = 0; i < ids.size(); i++) { cluster_weights[clusters[i]] += weights[i]; }
+	std::vector<int> merged = snap_orthogonal(&directions, &cluster_weights, cos_tol);
+	for (std::size_t i = 0; i < ids.size(); i++) { clusters[i] = merged[clusters[i]]; }
+
+	// Coplanar groups: sort each orientation cluster by offset
+	std::map<unsigned int, unsigned int> representatives;
+	std::vector<std::size_t> order(ids.size());
+	for (std::size_t i = 0; i < order.size(); i++) { order[i] = i; }
+	std::sort(order.begin(), order.end(),
+		      [&](const std::size_t &a, const std::size_t &b) {
+		      if (clusters[a] != clusters[b]) { return clusters[a] < clusters[b]; }
+		      return directions[clusters[a]] * (centroids[a] - CGAL::ORIGIN) <
+			         directions[clusters[b]] * (centroids[b] - CGAL::ORIGIN); });
+
+	std::size_t first = 0;
+	while (first < order.size()) {
+		// Collect group
+		int c = clusters[order[first]];
+		Vector_3 d = directions[c];
+		double start = d * (centroids[order[first]] - CGAL::ORIGIN);
+		std::size_t last = first + 1;
+		while (last < order.size() && clusters[order[last]] == c &&
+			   d * (centroids[order[last]] - CGAL::ORIGIN) - start <= params.distance_tolerance) {
+			last++;
+		}
+
+		// Weighted offset and representative
+		double offset = 0.0, total = 0.0;
+		std::size_t rep = order[first];
+		for (std::size_t k = first; k < last; k++) {
+			std::size_t i = order[k];
+			offset += weights[i] * (d * (centroids[i] - CGAL::ORIGIN));
+			total += weights[i];
+			if (weights[i] > weights[rep]) { rep = i; }
+		}
+		offset /= total;
+
+		// Assign shared plane, keeping original orientation
+		for (std::size_t k = first; k < last; k++) {
+			std::size_t i = order[k];
+			representatives[ids[i]] = ids[rep];
+		}
+		double sign = (normals[rep] * d < 0) ? -1.0 : 1.0;
+		(*plane_map)[ids[rep]] = Plane_3(sign * d.x(), sign * d.y(), sign * d.z(), -sign * offset);
+
+		first = last;
+	}
+
+	// Merge coplanar segments
+	for (auto pair : representatives) {
+		if (pair.first != pair.second) { plane_map->erase(pair.first); }
+	}
+	merge_coplanar_segments(mesh, G, &representatives);
+
+	return boost::num_vertices(*G);
+}
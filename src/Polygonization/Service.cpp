@@ -0,0 +1,562 @@
+/**
+ * MeshPolygonization is the implementation of the MVS (Multi-view Stereo) building mesh simplification method
+ * described in the following paper:
+ *      Vasileios Bouzas, Hugo Ledoux, and  Liangliang Nan.
+ *      Structure-aware Building Mesh Polygonization.
+ *      ISPRS Journal of Photogrammetry and Remote Sensing. 167(2020), 432-442, 2020.
+ * Please cite the above paper if you use the code/program (or part of it).
+ *
+ * LICENSE:
+ *      MeshPolygonization is free for academic use. If you are interested in a commercial license please contact
+ *      the 3D Geoinformation group.
+ *
+ * Copyright (C) 2019 3D Geoinformation Research Group
+ * https://3d.bk.tudelft.nl/
+ */
+
+#include "Service.h"
+#include "FileReader.h"
+#include "FileWritter.h"
+
+#include <chrono>
+#include <memory>
+#include <future>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <filesystem>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+namespace fs = std::filesystem;
+
+
+namespace {
+
+	typedef std::chrono::steady_clock Clock;
+
+	double seconds_since(Clock::time_point t0) {
+		return std::chrono::duration<double>(Clock::now() - t0).count();
+	}
+
+	// Set by SIGINT/SIGTERM
+	std::atomic<bool> signalled(false);
+
+	void on_signal(int) {
+		signalled = true;
+	}
+
+	std::mutex log_mutex;
+
+	const std::size_t max_line_length = 4096;
+
+	const char* solver_options[] = { "gurobi", "scip", "local_search", "soplex", "portfolio", "highs" };
+	const char* format_options[] = { "ply", "ply_binary", "obj" };
+
+
+	// Messages are single lines
+	std::string one_line(std::string text) {
+		std::replace(text.begin(), text.end(), '\n', ' ');
+		std::replace(text.begin(), text.end(), '\r', ' ');
+		return text;
+	}
+
+
+	// Buffered reader and writer over a connected socket
+	class Connection {
+	public:
+		explicit Connection(int fd) : fd_(fd), pos_(0) {}
+
+		// Next line, without the line break
+		bool read_line(std::string* line) {
+			for (;;) {
+				std::size_t end = buffer_.find('\n', pos_);
+				if (end != std::string::npos) {
+					line->assign(buffer_, pos_, end - pos_);
+					if (!line->empty() && line->back() == '\r') { line->pop_back(); }
+					pos_ = end + 1;
+					return true;
+				}
+				if (buffer_.size() - pos_ > max_line_length || !fill()) { return false; }
+			}
+		}
+
+		// Exactly size bytes
+		bool read_bytes(std::size_t size, std::string* data) {
+			std::size_t buffered = std::min(size, buffer_.size() - pos_);
+			data->assign(buffer_, pos_, buffered);
+			pos_ += buffered;
+			data->resize(size);
+			for (std::size_t done = buffered; done < size; ) {
+				long n = receive(&(*data)[done], size - done);
+				if (n <= 0) { return false; }
+				done += std::size_t(n);
+			}
+			return true;
+		}
+
+		bool write(const char* data, std::size_t size) {
+#ifndef _WIN32
+			std::lock_guard<std::mutex> lock(write_mutex_);
+			while (size > 0) {
+				long n = long(send(fd_, data, size, 0));
+				if (n < 0 && errno == EINTR) { continue; }
+				if (n <= 0) { return false; }
+				data += n;
+				size -= std::size_t(n);
+			}
+#endif
+			return true;
+		}
+
+		bool write_line(const std::string& line) {
+			std::string text = line + "\n";
+			return write(text.data(), text.size());
+		}
+
+	private:
+		long receive(char* data, std::size_t size) {
+#ifndef _WIN32
+			for (;;) {
+				long n = long(recv(fd_, data, size, 0));
+				if (n >= 0 || errno != EINTR) { return n; }
+			}
+#else
+			return -1;
+#endif
+		}
+
+		bool fill() {
+			buffer_.erase(0, pos_);
+			pos_ = 0;
+			char chunk[1 << 14];
+			long n = receive(chunk, sizeof(chunk));
+			if (n <= 0) { return false; }
+			buffer_.append(chunk, std::size_t(n));
+			return true;
+		}
+
+	private:
+		int fd_;
+		std::string buffer_;
+		std::size_t pos_;
+		std::mutex write_mutex_;
+	};
+
+
+	// Resolve a file path of a request (relative to root, symbolic links followed), false if it is not
+	// within root or no root is set
+	bool resolve_path(const std::string& root, std::string* path) {
+		if (root.empty()) { return false; }
+		std::error_code error;
+		fs::path base = fs::weakly_canonical(fs::absolute(root, error), error);
+		if (error) { return false; }
+		if (base.filename().empty()) { base = base.parent_path(); }
+		fs::path resolved = fs::weakly_canonical(base / *path, error);
+		if (error) { return false; }
+		auto r = resolved.begin();
+		for (auto b = base.begin(); b != base.end(); ++b, ++r) {
+			if (r == resolved.end() || *r != *b) { return false; }
+		}
+		*path = resolved.string();
+		return true;
+	}
+
+
+	// Polygonization request
+	struct Request {
+		PolygonizerConfig config;
+		Output_parameters::Format format = Output_parameters::PLY_ASCII;
+
+		// Input: file, or mesh content in mesh_format (off or ply)
+		std::string file;
+		std::string mesh_format;
+		std::string mesh;
+
+		// Write the result to this file instead of sending it
+		std::string output;
+	};
+
+
+	// Read the lines of a request up to "end". Invalid parameters are reported in error (the rest of the
+	// request is skipped); returns false if the connection is lost or the request cannot be followed.
+	bool read_request(Connection* conn, const Service_parameters& params, Request* request, std::string* error) {
+		std::string line;
+		while (conn->read_line(&line)) {
+			std::istringstream in(line);
+			std::string key;
+			if (!(in >> key)) { continue; }
+			if (key == "end") {
+				if (error->empty() && request->file.empty() && request->mesh_format.empty()) { *error = "no input mesh"; }
+				return true;
+			}
+
+			// Mesh content follows, consumed even if the request is invalid
+			if (key == "mesh") {
+				std::size_t size = 0;
+				if (!(in >> request->mesh_format >> size)) { *error = "invalid mesh header \'" + line + "\'"; return false; }
+				if (size > params.max_mesh_bytes) { *error = "mesh exceeds " + std::to_string(params.max_mesh_bytes) + " bytes"; return false; }
+				if (!conn->read_bytes(size, &request->mesh)) { return false; }
+				if (request->mesh_format != "off" && request->mesh_format != "ply" && error->empty()) {
+					*error = "unsupported mesh format \'" + request->mesh_format + "\'";
+				}
+				continue;
+			}
+			if (!error->empty()) { continue; }
+
+			PolygonizerConfig& config = request->config;
+			bool valid = true;
+			if (key == "rings") { valid = bool(in >> config.num_rings); }
+			else if (key == "distance") {
+				double distance = 0.0;
+				valid = bool(in >> distance) && distance > 0.0;
+				if (valid) { config.set_distance_threshold(distance); }
+			}
+			else if (key == "importance") { valid = bool(in >> config.importance_threshold); }
+			else if (key == "weights") {
+				std::string weights;
+				in >> weights;
+				std::replace(weights.begin(), weights.end(), ':', ' ');
+				std::istringstream values(weights);
+				Objective_weights& w = config.optimization.weights;
+				valid = bool(values >> w.fitting >> w.coverage >> w.complexity);
+			}
+			else if (key == "solver") {
+				std::string name;
+				in >> name;
+				valid = false;
+				for (int i = 0; i < 6; i++) {
+					if (name == solver_options[i]) { config.solver = static_cast<LinearProgramSolver::SolverName>(i); valid = true; }
+				}
+			}
+			else if (key == "time_limit") { valid = bool(in >> config.optimization.budget.time_limit); }
+			else if (key == "format") {
+				std::string name;
+				in >> name;
+				valid = false;
+				for (int i = 0; i < 3; i++) {
+					if (name == format_options[i]) { request->format = static_cast<Output_parameters::Format>(i); valid = true; }
+				}
+			}
+			else if (key == "polygons") { config.triangulate = false; }
+			else if (key == "file" || key == "output") {
+				std::string& path = (key == "file") ? request->file : request->output;
+				valid = bool(in >> std::ws) && std::getline(in, path) && !path.empty();
+				if (valid && params.file_root.empty()) { *error = "file paths are not allowed by the service"; continue; }
+				if (valid && !resolve_path(params.file_root, &path)) { *error = "path outside of the service root \'" + path + "\'"; continue; }
+			}
+			else { *error = "unknown parameter \'" + key + "\'"; continue; }
+
+			if (!valid) { *error = "invalid parameter \'" + line + "\'"; }
+		}
+		return false;
+	}
+
+
+	// Run a request, streaming its progress
+	void process(Connection* conn, const Request& request) {
+		Clock::time_point t0 = Clock::now();
+		auto stage_line = [conn](const std::string& stage, double secs, bool cached) {
+			std::ostringstream line;
+			line << "stage " << stage << " " << std::fixed << std::setprecision(3) << secs << (cached ? " cached" : "");
+			conn->write_line(line.str());
+		};
+		std::string source = request.file.empty() ? "<" + std::to_string(request.mesh.size()) + " bytes>" : request.file;
+		std::string outcome;
+
+		try {
+			Mesh mesh;
+			bool read = request.file.empty() ? readMesh(request.mesh.data(), request.mesh.data() + request.mesh.size(), request.mesh_format, &mesh)
+				                             : readMesh(request.file, &mesh);
+			if (!read) {
+				outcome = "failed to read mesh";
+			}
+			else {
+				stage_line("read", seconds_since(t0), false);
+
+				Polygonizer polygonizer(request.config);
+				PolygonizerResult result = polygonizer.apply(&mesh, stage_line);
+				const PolygonizerStats& stats = result.stats;
+				conn->write_line("stats segments=" + std::to_string(stats.num_segments) + " planes=" + std::to_string(stats.num_planes)
+					             + " candidates=" + std::to_string(stats.num_candidates) + " faces=" + std::to_string(stats.num_faces));
+
+				if (!result.success) {
+					outcome = "no polygonal surface was obtained";
+				}
+				else if (!request.output.empty()) {
+					if (writeSimplified(&result.mesh, request.output, request.format)) { conn->write_line("result file " + request.output); }
+					else { outcome = "failed to write \'" + request.output + "\'"; }
+				}
+				else {
+					std::string data;
+					writeSimplified(&result.mesh, &data, request.format);
+					conn->write_line(std::string("result ") + format_options[request.format] + " " + std::to_string(data.size()));
+					conn->write(data.data(), data.size());
+				}
+			}
+		}
+		catch (const std::exception& e) {
+			outcome = one_line(e.what());
+		}
+
+		conn->write_line(outcome.empty() ? std::string("done") : "error " + outcome);
+
+		std::ostringstream log;
+		log << "Request " << source << ": " << (outcome.empty() ? std::string("done") : outcome) << ", "
+			<< std::fixed << std::setprecision(2) << seconds_since(t0) << " secs";
+		std::lock_guard<std::mutex> lock(log_mutex);
+		std::cout << log.str() << std::endl;
+	}
+
+}
+
+
+Service::Service(const PolygonizerConfig& config, const Service_parameters& params)
+	: config_(config)
+	, params_(params)
+	, stopping_(false)
+	, num_active_(0)
+{
+	config_.verbose = false;
+	params_.max_queue = std::max<std::size_t>(params_.max_queue, 1);
+
+	std::size_t num_cores = std::max(1u, std::thread::hardware_concurrency());
+	num_workers_ = (params_.num_workers > 0) ? params_.num_workers : num_cores;
+	threads_per_worker_ = (params_.threads_per_worker > 0) ? params_.threads_per_worker : std::max<std::size_t>(1, num_cores / num_workers_);
+}
+
+
+Service::~Service()
+{
+}
+
+
+bool Service::run() {
+#ifdef _WIN32
+	std::cerr << "The service needs Unix domain sockets, which are not available on this platform" << std::endl;
+	return false;
+#else
+	const std::string& path = params_.socket_path;
+	sockaddr_un address;
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+		std::cerr << "Invalid socket path \'" << path << "\'" << std::endl;
+		return false;
+	}
+	std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+	// A socket file left by a previous run is replaced, unless a service still listens on it
+	int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener >= 0 && connect(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+		std::cerr << "Another service is listening on \'" << path << "\'" << std::endl;
+		close(listener);
+		return false;
+	}
+	if (listener >= 0) { close(listener); }
+	unlink(path.c_str());
+
+	listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0) {
+		std::cerr << "Failed to listen on \'" << path << "\': " << std::strerror(errno) << std::endl;
+		if (listener >= 0) { close(listener); }
+		return false;
+	}
+
+	// Lost clients must not terminate the service
+	std::signal(SIGPIPE, SIG_IGN);
+	signalled = false;
+	std::signal(SIGINT, on_signal);
+	std::signal(SIGTERM, on_signal);
+
+	stopping_ = false;
+	for (std::size_t i = 0; i < num_workers_; i++) {
+		workers_.emplace_back(&Service::worker_loop, this);
+	}
+	std::cout << "Service: listening on \'" << path << "\' with " << num_workers_ << " workers x " << threads_per_worker_ << " threads" << std::endl;
+
+	// Accept connections, each served by its own thread
+	while (!stopping_ && !signalled) {
+		pollfd listening = { listener, POLLIN, 0 };
+		if (poll(&listening, 1, 200) <= 0) { continue; }
+		int fd = accept(listener, nullptr, nullptr);
+		if (fd < 0) { continue; }
+
+		std::unique_lock<std::mutex> lock(connection_mutex_);
+		if (connections_.size() >= params_.max_connections) {
+			lock.unlock();
+			Connection(fd).write_line("busy too many connections");
+			close(fd);
+			continue;
+		}
+		connections_.insert(fd);
+		lock.unlock();
+		std::thread(&Service::serve_connection, this, fd).detach();
+	}
+
+	// Stop accepting, cancel the waiting requests and let the running ones finish
+	stopping_ = true;
+	close(listener);
+	unlink(path.c_str());
+	{
+		std::lock_guard<std::mutex> lock(queue_mutex_);
+	}
+	job_ready_.notify_all();
+	slot_free_.notify_all();
+	for (auto& worker : workers_) { worker.join(); }
+	workers_.clear();
+
+	// Close the connections
+	{
+		std::unique_lock<std::mutex> lock(connection_mutex_);
+		for (int fd : connections_) { shutdown(fd, SHUT_RDWR); }
+		connection_closed_.wait(lock, [this] { return connections_.empty(); });
+	}
+
+	std::signal(SIGINT, SIG_DFL);
+	std::signal(SIGTERM, SIG_DFL);
+	std::cout << "Service: stopped" << std::endl;
+	return true;
+#endif
+}
+
+
+void Service::worker_loop() {
+#ifdef _OPENMP
+	// Per thread setting, applies to the parallel regions of this worker
+	omp_set_num_threads(int(threads_per_worker_));
+#endif
+
+	for (;;) {
+		Job job;
+		bool cancelled = false;
+		{
+			std::unique_lock<std::mutex> lock(queue_mutex_);
+			job_ready_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+			if (queue_.empty()) { return; }
+			job = queue_.front();
+			queue_.pop_front();
+			cancelled = stopping_;
+			if (!cancelled) { num_active_++; }
+		}
+		slot_free_.notify_one();
+
+		if (cancelled) {
+			job.cancel();
+			continue;
+		}
+		job.run();
+
+		std::lock_guard<std::mutex> lock(queue_mutex_);
+		num_active_--;
+	}
+}
+
+
+bool Service::submit(const Job& job, std::size_t* position) {
+	std::unique_lock<std::mutex> lock(queue_mutex_);
+	if (params_.block_when_full) {
+		slot_free_.wait(lock, [this] { return stopping_ || queue_.size() < params_.max_queue; });
+	}
+	if (stopping_ || queue_.size() >= params_.max_queue) { return false; }
+
+	queue_.push_back(job);
+	*position = queue_.size();
+	lock.unlock();
+	job_ready_.notify_one();
+	return true;
+}
+
+
+void Service::serve_connection(int fd) {
+	{
+		Connection conn(fd);
+		std::string line;
+		while (!stopping_ && conn.read_line(&line)) {
+			std::istringstream in(line);
+			std::string command;
+			if (!(in >> command)) { continue; }
+			if (command == "ping") { conn.write_line("pong"); continue; }
+			if (command == "status") { conn.write_line(status()); continue; }
+			if (command != "polygonize") { conn.write_line("error unknown command \'" + one_line(command) + "\'"); continue; }
+
+			// Request, from the service configuration
+			std::shared_ptr<Request> request(new Request);
+			request->config = config_;
+			request->format = Output_parameters::PLY_ASCII;
+			if (request->config.optimization.budget.num_threads == 0) {
+				request->config.optimization.budget.num_threads = int(threads_per_worker_);
+			}
+			std::string error;
+			bool complete = read_request(&conn, params_, request.get(), &error);
+			if (!error.empty()) { conn.write_line("error " + one_line(error)); }
+			if (!complete) { break; }
+			if (!error.empty()) { continue; }
+
+			// Admission. The job starts writing only after "queued", and this thread waits for it,
+			// so that the responses of a connection never interleave.
+			auto admitted = std::make_shared<std::promise<void>>();
+			auto finished = std::make_shared<std::promise<void>>();
+			std::shared_future<void> admitted_future = admitted->get_future().share();
+			std::future<void> finished_future = finished->get_future();
+			Connection* connection = &conn;
+			Job job;
+			job.run = [connection, request, admitted_future, finished]() {
+				admitted_future.wait();
+				process(connection, *request);
+				finished->set_value();
+			};
+			job.cancel = [connection, admitted_future, finished]() {
+				admitted_future.wait();
+				connection->write_line("error service stopping");
+				finished->set_value();
+			};
+
+			std::size_t position = 0;
+			if (!submit(job, &position)) {
+				conn.write_line(stopping_ ? "error service stopping" : "busy queue full");
+				continue;
+			}
+			conn.write_line("queued " + std::to_string(position));
+			admitted->set_value();
+			finished_future.wait();
+		}
+	}
+
+	// Unregister, and notify while holding the lock: the service may be gone right after
+	std::lock_guard<std::mutex> lock(connection_mutex_);
+#ifndef _WIN32
+	close(fd);
+#endif
+	connections_.erase(fd);
+	connection_closed_.notify_all();
+}
+
+
+std::string Service::status() {
+	std::size_t num_active = 0, num_queued = 0, num_connections = 0;
+	{
+		std::lock_guard<std::mutex> lock(queue_mutex_);
+		num_active = num_active_;
+		num_queued = queue_.size();
+	}
+	{
+		std::lock_guard<std::mutex> lock(connection_mutex_);
+		num_connections = connections_.size();
+	}
+	return "status workers=" + std::to_string(num_workers_) + " active=" + std::to_string(num_active)
+		   + " queued=" + std::to_string(num_queued) + " connections=" + std::to_string(num_connections);
+}
@@ -0,0 +1,125 @@
+/**
+ * MeshPolygonization is the implementation of the MVS (Multi-view Stereo) building mesh simplification method
+ * described in the following paper:
+ *      Vasileios Bouzas, Hugo Ledoux, and  Liangliang Nan.
+ *      Structure-aware Building Mesh Polygonization.
+ *      ISPRS Journal of Photogrammetry and Remote Sensing. 167(2020), 432-442, 2020.
+ * Please cite the above paper if you use the code/program (or part of it).
+ *
+ * LICENSE:
+ *      MeshPolygonization is free for academic use. If you are interested in a commercial license please contact
+ *      the 3D Geoinformation group.
+ *
+ * Copyright (C) 2019 3D Geoinformation Research Group
+ * https://3d.bk.tudelft.nl/
+ */
+
+#pragma once
+
+#include "Polygonizer.h"
+
+#include <set>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+
+// SERVICE PARAMETERS //
+struct Service_parameters {
+	// Path of the Unix domain socket
+	std::string socket_path = "/tmp/MeshPolygonization.sock";
+
+	// Number of workers (0 for one per core), each with threads_per_worker OpenMP and solver threads
+	// (0 to share the cores among the workers)
+	std::size_t num_workers = 0;
+	std::size_t threads_per_worker = 0;
+
+	// Admission: maximum number of requests waiting for a worker. When the queue is full, new requests
+	// are refused with "busy", or wait for a free slot (back-pressure on the client) if block_when_full.
+	std::size_t max_queue = 64;
+	bool block_when_full = false;
+
+	// Maximum number of open connections, further ones are refused with "busy"
+	std::size_t max_connections = 64;
+
+	// Maximum size of a mesh sent in a request (bytes)
+	std::size_t max_mesh_bytes = std::size_t(256) << 20;
+
+	// Directory that the file and output paths of the requests must be within (relative paths are
+	// relative to it). Empty to refuse these fields: meshes and results then go through the socket only.
+	// NOTE: any client that can connect to the socket can read and write the files under this directory
+	//       with the permissions of the service.
+	std::string file_root;
+};
+// SERVICE PARAMETERS //
+
+
+// Long-running polygonization service over a Unix domain socket
+// Workers stay alive between requests, so that their solver environments (e.g., the Gurobi environment
+// of each thread) are created once. Each connection sends requests one after the other:
+//
+//     polygonize                    (request)
+//     distance 0.5                  (optional parameters: rings, distance, importance, weights a:b:c,
+//     solver highs                   solver, time_limit, format ply|ply_binary|obj, polygons)
+//     mesh off 123456               (mesh content of this many bytes follows, off or ply;
+//     <content>                      or: file /path/to/mesh.off, within Service_parameters::file_root)
+//     output /path/to/result.ply    (optional: write the result to this file instead of sending it,
+//                                    within Service_parameters::file_root)
+//     end
+//
+// and gets back lines, streamed as the request progresses:
+//
+//     queued <position>
+//     stage <name> <secs> [cached]  (read, planarity, segmentation, structure_graph, scaffold, face_selection)
+//     stats segments=<n> planes=<n> candidates=<n> faces=<n>
+//     result <format> <bytes>       (result content follows; or: result file <path>)
+//     done
+//
+// A response ends with "done", "error <message>" or "busy <message>". Commands "ping" and "status"
+// answer "pong" and "status workers=<n> active=<n> queued=<n> connections=<n>".
+class Service
+{
+public:
+	// Requests start from config, overriding the parameters they specify
+	Service(const PolygonizerConfig& config, const Service_parameters& params);
+	~Service();
+
+	// Listen and serve until SIGINT/SIGTERM or stop(). Returns false if the socket cannot be set up.
+	bool run();
+
+	void stop() { stopping_ = true; }
+
+private:
+	struct Job {
+		std::function<void()> run;
+		std::function<void()> cancel;    // the service stops before the job runs
+	};
+
+	void worker_loop();
+	bool submit(const Job& job, std::size_t* position);
+	void serve_connection(int fd);
+	std::string status();
+
+private:
+	PolygonizerConfig config_;
+	Service_parameters params_;
+	std::size_t num_workers_;
+	std::size_t threads_per_worker_;
+	std::atomic<bool> stopping_;
+
+	// Worker pool
+	std::vector<std::thread> workers_;
+	std::deque<Job> queue_;
+	std::size_t num_active_;
+	std::mutex queue_mutex_;
+	std::condition_variable job_ready_;
+	std::condition_variable slot_free_;
+
+	// Open connections, shut down when the service stops
+	std::set<int> connections_;
+	std::mutex connection_mutex_;
+	std::condition_variable connection_closed_;
+};
@@ -18,8 +18,13 @@
 #include "Segment.h"
 #include "Intersection.h"
 #include "CandidateFace.h"
+#include "CandidateMerging.h"
 #include "Optimization.h"
 #include "Orientation.h"
+#include "FileWritter.h"
+#include "solver/linear_program_io.h"
+
+#include <CGAL/IO/polygon_soup_io.h>
 
 
 Simplification::Simplification()
@@ -32,13 +37,30 @@ Simplification::~Simplification()
 }
 
 
-Mesh Simplification::apply(const Mesh* mesh, const Graph* G, LinearProgramSolver::SolverName solver_name) {
+// Construct scaffold
+void Simplification::construct_scaffold(const Mesh* mesh, const Graph* structure_graph, std::map<unsigned int, Plane_3>* planes,
+	                                    std::vector<Triple_intersection>* scaffold_vertices, std::vector<Plane_intersection>* scaffold_edges,
+	                                    std::vector<Candidate_face>* candidate_faces) {
 	// Compute bbox of original mesh
 	Bbox_3 bbox = CGAL::Polygon_mesh_processing::bbox(*mesh);
 
+	// Regularization merges graph vertices and relabels segments, work on copies
+	Graph graph = *structure_graph;
+	const Graph* G = &graph;
+	Mesh regularized_mesh;
+
 	// Supporting plane map
 	std::map<unsigned int, Plane_3> plane_map = compute_supporting_planes(mesh, G);
 
+	// Regularize supporting planes
+	if (regularization_.enabled) {
+		regularized_mesh = *mesh;
+		mesh = &regularized_mesh;
+		std::size_t num_planes = plane_map.size();
+		std::size_t num_regularized = regularize_planes(&regularized_mesh, &graph, &plane_map, regularization_);
+		if (verbose_) { std::cout << "Regularized planes: " << num_planes << " -> " << num_regularized << std::endl; }
+	}
+
 	// Compute mesh vertices
 	std::vector<Triple_intersection> vertices = compute_mesh_vertices(&bbox, G, &plane_map);
 
@@ -52,8 +74,15 @@ Mesh Simplification::apply(const Mesh* mesh, const Graph* G, LinearProgramSolver
 	// Compute mesh faces
 	std::vector<Candidate_face> faces = compute_mesh_faces(mesh, G, &plane_map, &edges);
 
-	// Optimize
-	return simplify(&vertices, &edges, &faces, solver_name);;
+	// Merge coplanar cells split by unusable edges
+	std::size_t num_faces = faces.size();
+	merge_candidate_faces(&faces, &edges);
+	if (verbose_) { std::cout << "Candidate faces: " << num_faces << " -> " << faces.size() << std::endl; }
+
+	planes->swap(plane_map);
+	scaffold_vertices->swap(vertices);
+	scaffold_edges->swap(edges);
+	candidate_faces->swap(faces);
 }
 
 
@@ -376,17 +405,7 @@ std::vector<Candidate_face> Simplification::compute_mesh_faces(const Mesh* mesh,
 	}
 
 	// Update edges
-	for (auto i = 0; i < edges->size(); i++) {
-		// Check all faces
-		for (auto j = 0; j < candidate_faces.size(); j++) {
-			// Retrieve face edges
-			auto e = candidate_faces[j].edges;
-
-			// If edge found, update
-			auto pos = std::find(e.begin(), e.end(), i);
-			if (pos != e.end()) { (*edges)[i].faces.push_back(j); }
-		}
-	}
+	update_edge_faces(&candidate_faces, edges);
 
 	return candidate_faces;
 }
@@ -394,77 +413,92 @@ std::vector<Candidate_face> Simplification::compute_mesh_faces(const Mesh* mesh,
 
 // Simplify
 Mesh Simplification::simplify(std::vector<Triple_intersection>* vertices, std::vector<Plane_intersection>* edges, std::vector<Candidate_face>* faces, LinearProgramSolver::SolverName solver_name) {
-	// Construct proxy mesh
-	Mesh proxy_mesh;
-
-	// Face attributes //
-	// Face index
-	Mesh::Property_map<Face, std::size_t> face_indices = proxy_mesh.add_property_map<Face, std::size_t>("f:index").first;
-
-	// Vertex indices
-	Mesh::Property_map<Face, std::vector<int>> vertex_indices = proxy_mesh.add_property_map<Face, std::vector<int>>("f:vertices").first;
-
-	// Number of supporting faces
-	Mesh::Property_map<Face, std::size_t> supporting_face_num = proxy_mesh.add_property_map<Face, std::size_t>("f:supporting_face_num").first;
-
-	// Covered area
-	Mesh::Property_map<Face, double> covered_area = proxy_mesh.add_property_map<Face, double>("f:covered_area").first;
-
-	// Total area
-	Mesh::Property_map<Face, double> area = proxy_mesh.add_property_map<Face, double>("f:area").first;
-	// Face attributes //
-
-	// Define faces
-	for (auto face : *faces) {
-		// Add topology
-		std::vector<Vertex> face_vertices;
-		for (auto i : face.vertices) {
-			Triple_intersection vertex = (*vertices)[i];
-			Vertex v = proxy_mesh.add_vertex(vertex.point);
-			face_vertices.push_back(v);
-		}
-		Face f = proxy_mesh.add_face(face_vertices);
+	// Prune hopeless faces, only the surviving ones are optimized
+	if (pruning_.enabled) {
+		std::size_t num_faces = faces->size();
+		prune_candidate_faces(faces, edges, pruning_);
+		if (verbose_) { std::cout << "Pruned candidate faces: " << num_faces << " -> " << faces->size() << std::endl; }
+	}
 
-		// Add attributes
-		vertex_indices[f] = face.vertices;                 // Vertex indices
-		supporting_face_num[f] = face.supporting_face_num; // Number of supporting faces
-		covered_area[f] = face.covered_area;               // Covered area
-		area[f] = face.area;                               // Total area
+	// Export program and candidate faces instead of optimizing
+	if (!export_name_.empty()) {
+		program_exported_ = export_program(vertices, edges, faces);
+		return Mesh();
+	}
 
-		// Update edges
-		// Retrieve face edges
-		auto face_edges = face.edges;
-		for (auto i = 0; i < edges->size(); i++) {
-			// Check if edge is in face edges
-			auto pos = std::find(face_edges.begin(), face_edges.end(), i);
+	// Optimize over the candidate faces, variables follow their order
+	std::vector<double> X = optimize(vertices, faces, edges, solver_name, optimization_);
+	if (X.empty()) {
+		std::cerr << "Optimization failed: no solution within the solver budget" << std::endl;
+		return Mesh();
+	}
 
-			// If so, add to edge fan
-			if (pos != face_edges.end()) { 
-				(*edges)[i].fan.push_back(f);
-			}
-		}
+	// Selected faces, sharing the scaffold vertices
+	std::vector<std::vector<int>> selected;
+	for (std::size_t j = 0; j < faces->size(); j++) {
+		if (static_cast<int>(std::round(X[j])) == 1) { selected.push_back((*faces)[j].vertices); }
 	}
 
-	// Optimize
-	std::vector<double> X = optimize(&proxy_mesh, edges, solver_name);
+	// Ensure consistent orientation
+	Mesh mesh;
+	orient(mesh, *vertices, selected, triangulate_);
+	return mesh;
+}
+
+
+// Export face selection program
+bool Simplification::export_program(const std::vector<Triple_intersection>* vertices, const std::vector<Plane_intersection>* edges, const std::vector<Candidate_face>* faces) {
+	// Complete program
+	Face_selection_problem problem = compute_selection_problem(vertices, faces, edges, optimization_.weights);
+	LinearProgram program;
+	program.set_name("face_selection");
+	build_selection_program(&problem, &program);
+
+	bool written = write_mps(&program, export_name_ + ".mps");
+	written = write_lp(&program, export_name_ + ".lp") && written;
+
+	// Candidate faces, in the order of the face variables
+	std::vector<Point_3> points;
+	for (auto vertex : *vertices) {
+		points.push_back(vertex.point);
+	}
+	std::vector<std::vector<int>> polygons;
+	for (auto& face : *faces) {
+		polygons.push_back(face.vertices);
+	}
+	written = writeCandidates(&points, &polygons, export_name_ + "-candidates.off") && written;
 
-	// Faces to delete
-	std::vector<Face> to_delete;
-	std::size_t f_idx(0);
-	for (auto f : proxy_mesh.faces()) {
-		if (static_cast<int>(std::round(X[f_idx])) == 0)
-			to_delete.push_back(f);
-		++f_idx;
+	if (written && verbose_) {
+		std::cout << "Program exported: " << program.num_variables() << " variables, " << program.num_constraints()
+			      << " constraints to \'" << export_name_ << ".mps\' and \'" << export_name_ << ".lp\'" << std::endl;
 	}
+	return written;
+}
 
-	// Face deletion
-	for (std::size_t i = 0; i < to_delete.size(); ++i) {
-	    Face f = to_delete[i];
-		Halfedge h = proxy_mesh.halfedge(f);
-		CGAL::Euler::remove_face(h, proxy_mesh);
+
+// Assemble surface from offline solution
+Mesh Simplification::resume(const std::string& base_name, const std::string& solution_file) {
+	// Candidate faces
+	std::vector<Point_3> points;
+	std::vector<std::vector<int>> polygons;
+	const std::string candidates_file = base_name + "-candidates.off";
+	if (!CGAL::IO::read_polygon_soup(candidates_file, points, polygons)) {
+		std::cerr << "Failed to load candidate faces from file \'" << candidates_file << "\'" << std::endl;
+		return Mesh();
 	}
 
+	// Face labels, the other variables are not needed
+	std::vector<double> X;
+	if (!read_solution(solution_file, selection_variable_names(polygons.size(), 0), &X)) { return Mesh(); }
+
+	std::vector<std::vector<int>> selected;
+	for (std::size_t i = 0; i < polygons.size(); i++) {
+		if (static_cast<int>(std::round(X[i])) == 1) { selected.push_back(polygons[i]); }
+	}
+	std::cout << "Selected faces: " << selected.size() << " of " << polygons.size() << std::endl;
+
 	// Ensure consistent orientation
-	orient(proxy_mesh, *vertices);
-	return proxy_mesh;
-}
\ No newline at end of file
+	Mesh mesh;
+	assemble_surface(mesh, points, selected, triangulate_);
+	return mesh;
+}
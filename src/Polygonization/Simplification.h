@@ -18,6 +18,9 @@
 
 #include "Utils.h"
 #include "StructureGraph.h"
+#include "Regularization.h"
+#include "Pruning.h"
+#include "Optimization.h"
 #include "solver/linear_program_solver.h"
 
 
@@ -27,7 +30,37 @@ public:
 	Simplification();
 	~Simplification();
 
-	Mesh apply(const Mesh* mesh, const Graph* G, LinearProgramSolver::SolverName solver_name);
+	// The two stages run separately (e.g., one scaffold for several face selections)
+	// Scaffold: regularized supporting planes, vertices, edges and candidate faces
+	void construct_scaffold(const Mesh* mesh, const Graph* G, std::map<unsigned int, Plane_3>* plane_map, std::vector<Triple_intersection>* vertices,
+		                    std::vector<Plane_intersection>* edges, std::vector<Candidate_face>* faces);
+	// Face selection: prunes and optimizes the candidate faces (modified), then assembles the surface
+	Mesh simplify(std::vector<Triple_intersection>* vertices, std::vector<Plane_intersection>* edges, std::vector<Candidate_face>* faces, LinearProgramSolver::SolverName solver_name);
+
+	// Plane regularization before scaffold construction
+	void set_regularization(const Regularization_parameters& params) { regularization_ = params; }
+
+	// Candidate face pruning before optimization
+	void set_pruning(const Pruning_parameters& params) { pruning_ = params; }
+
+	// Face selection
+	void set_optimization(const Optimization_parameters& params) { optimization_ = params; }
+
+	// Triangulate the selected faces, otherwise the result keeps the planar polygons
+	void set_triangulation(bool triangulate) { triangulate_ = triangulate; }
+
+	// Print the scaffold and pruning summaries (the optimization has its own flag, see Optimization_parameters)
+	void set_verbose(bool verbose) { verbose_ = verbose; }
+
+	// Stop after building the face selection program and write it to <base_name>.mps and <base_name>.lp,
+	// with the candidate faces to <base_name>-candidates.off (face i is variable f<i>). simplify() then returns an empty mesh.
+	void set_program_export(const std::string& base_name) { export_name_ = base_name; }
+
+	// Whether the last simplify() wrote all the exported files
+	bool program_exported() const { return program_exported_; }
+
+	// Assemble the surface from exported candidate faces and a solution file, without any geometry computation
+	Mesh resume(const std::string& base_name, const std::string& solution_file);
 
 private:
 	std::vector<Triple_intersection> compute_mesh_vertices(const Bbox_3* bbox, const Graph* G, std::map<unsigned int, Plane_3>* plane_map);
@@ -37,6 +70,15 @@ private:
 	void cross_section_split(std::vector<Plane_intersection>* edges, Plane_intersection* e, const Point_3* pt, int idx);
 	void refine_edges(std::vector<Plane_intersection>* edges, std::vector<Triple_intersection>* vertices, std::map<unsigned int, Plane_3>* plane_map);
 	std::vector<Candidate_face> compute_mesh_faces(const Mesh* mesh, const Graph* G, std::map<unsigned int, Plane_3>* plane_map, std::vector<Plane_intersection>* edges);
-	Mesh simplify(std::vector<Triple_intersection>* vertices, std::vector<Plane_intersection>* edges, std::vector<Candidate_face>* faces, LinearProgramSolver::SolverName solver_name);
+	bool export_program(const std::vector<Triple_intersection>* vertices, const std::vector<Plane_intersection>* edges, const std::vector<Candidate_face>* faces);
+
+private:
+	Regularization_parameters regularization_;
+	Pruning_parameters pruning_;
+	Optimization_parameters optimization_;
+	std::string export_name_;
+	bool program_exported_ = false;
+	bool triangulate_ = true;
+	bool verbose_ = true;
 };
 
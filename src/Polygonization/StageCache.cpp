@@ -0,0 +1,490 @@
+/**
+ * MeshPolygonization is the implementation of the MVS (Multi-view Stereo) building mesh simplification method
+ * described in the following paper:
+ *      Vasileios Bouzas, Hugo Ledoux, and  Liangliang Nan.
+ *      Structure-aware Building Mesh Polygonization.
+ *      ISPRS Journal of Photogrammetry and Remote Sensing. 167(2020), 432-442, 2020.
+ * Please cite the above paper if you use the code/program (or part of it).
+ *
+ * LICENSE:
+ *      MeshPolygonization is free for academic use. If you are interested in a commercial license please contact
+ *      the 3D Geoinformation group.
+ *
+ * Copyright (C) 2019 3D Geoinformation Research Group
+ * https://3d.bk.tudelft.nl/
+ */
+
+#include "StageCache.h"
+#include "FileReader.h"
+#include "FileWritter.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <thread>
+#include <sstream>
+#include <iomanip>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace {
+
+	const char			magic[4] = { 'P', 'S', 'T', 'G' };
+	const std::uint32_t version = 1;
+
+	const std::uint64_t fnv_offset = 14695981039346656037ull;
+	const std::uint64_t fnv_prime = 1099511628211ull;
+
+	const char* stage_names[] = { "planarity", "segmentation", "graph", "scaffold" };
+
+	bool make_directory(const std::string& directory) {
+#ifdef _WIN32
+		return _mkdir(directory.c_str()) == 0 || errno == EEXIST;
+#else
+		return mkdir(directory.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+	}
+
+	int process_id() {
+#ifdef _WIN32
+		return _getpid();
+#else
+		return static_cast<int>(getpid());
+#endif
+	}
+
+
+	// Bounds-checked reader of a mapped artifact
+	class Artifact_reader {
+	public:
+		Artifact_reader(const char* begin, const char* end) : p_(begin), end_(end), ok_(true) {}
+
+		bool ok() const { return ok_; }
+		bool at_end() const { return ok_ && p_ == end_; }
+
+		template <typename T>
+		T get() {
+			T value = T();
+			if (!ok_ || std::size_t(end_ - p_) < sizeof(T)) { ok_ = false; return value; }
+			std::memcpy(&value, p_, sizeof(T));
+			p_ += sizeof(T);
+			return value;
+		}
+
+		// Number of elements, checked against the remaining bytes
+		std::size_t count(std::size_t element_size) {
+			std::uint64_t n = get<std::uint64_t>();
+			if (!ok_ || n > std::uint64_t(end_ - p_) / element_size) { ok_ = false; return 0; }
+			return std::size_t(n);
+		}
+
+		Point_3 point() {
+			double x = get<double>(), y = get<double>(), z = get<double>();
+			return Point_3(x, y, z);
+		}
+
+		template <typename Container>
+		void ints(Container* values) {
+			std::size_t n = count(sizeof(std::int32_t));
+			for (std::size_t i = 0; i < n; i++) { values->insert(values->end(), int(get<std::int32_t>())); }
+		}
+
+	private:
+		const char* p_;
+		const char* end_;
+		bool ok_;
+	};
+
+
+	void write_point(Buffered_writer* out, const Point_3& p) {
+		out->binary(double(p.x()));
+		out->binary(double(p.y()));
+		out->binary(double(p.z()));
+	}
+
+	template <typename Container>
+	void write_ints(Buffered_writer* out, const Container& values) {
+		out->binary(std::uint64_t(values.size()));
+		for (auto v : values) { out->binary(std::int32_t(v)); }
+	}
+
+
+	void write_header(Buffered_writer* out, StageCache::Stage stage, std::uint64_t key, const Mesh* mesh) {
+		out->text(std::string(magic, 4));
+		out->binary(version);
+		out->binary(std::uint32_t(stage));
+		out->binary(key);
+		out->binary(std::uint64_t(mesh ? mesh->number_of_vertices() : 0));
+		out->binary(std::uint64_t(mesh ? mesh->number_of_faces() : 0));
+	}
+
+	bool read_header(Artifact_reader* in, StageCache::Stage stage, std::uint64_t key, const Mesh* mesh) {
+		char m[4];
+		for (int i = 0; i < 4; i++) { m[i] = in->get<char>(); }
+		std::uint32_t file_version = in->get<std::uint32_t>();
+		std::uint32_t file_stage = in->get<std::uint32_t>();
+		std::uint64_t file_key = in->get<std::uint64_t>();
+		std::uint64_t num_vertices = in->get<std::uint64_t>();
+		std::uint64_t num_faces = in->get<std::uint64_t>();
+		if (!in->ok() || std::memcmp(m, magic, 4) != 0 || file_version != version || file_stage != std::uint32_t(stage) || file_key != key) {
+			return false;
+		}
+		return !mesh || (num_vertices == mesh->number_of_vertices() && num_faces == mesh->number_of_faces());
+	}
+
+
+	// Write artifact to a temporary file (unique to the process and thread), then rename it
+	template <typename Payload>
+	bool write_artifact(const std::string& name, Payload payload) {
+		std::ostringstream temporary_name;
+		temporary_name << name << "." << process_id() << "." << std::this_thread::get_id() << ".tmp";
+		const std::string temporary = temporary_name.str();
+		{
+			Buffered_writer out(temporary);
+			if (!out.is_open()) {
+				std::cerr << "could not write the stage artifact \'" << name << "\'" << std::endl;
+				return false;
+			}
+			payload(&out);
+			if (!out.close()) {
+				std::remove(temporary.c_str());
+				return false;
+			}
+		}
+
+#ifdef _WIN32
+		std::remove(name.c_str());	// rename() does not replace an existing file on Windows
+#endif
+		if (std::rename(temporary.c_str(), name.c_str()) != 0) {
+			std::remove(temporary.c_str());
+			return false;
+		}
+		return true;
+	}
+
+}
+
+
+StageCache::StageCache(const std::string& directory)
+	: directory_(directory)
+{
+	if (!make_directory(directory_))
+		std::cerr << "could not create the stage cache directory \'" << directory_ << "\'" << std::endl;
+}
+
+
+StageCache::~StageCache()
+{
+}
+
+
+std::uint64_t StageCache::hash_file(const std::string& file) {
+	Mapped_file mapped(file);
+	std::uint64_t h = fnv_offset;
+	if (!mapped.is_open()) { return h; }
+
+	// FNV-1a over 8-byte words, then the tail bytes
+	const char* p = mapped.begin();
+	for (; mapped.end() - p >= 8; p += 8) {
+		std::uint64_t word;
+		std::memcpy(&word, p, 8);
+		h ^= word;
+		h *= fnv_prime;
+	}
+	for (; p < mapped.end(); ++p) {
+		h ^= static_cast<unsigned char>(*p);
+		h *= fnv_prime;
+	}
+	return combine(h, double(mapped.end() - mapped.begin()));
+}
+
+
+std::uint64_t StageCache::hash_mesh(const Mesh* mesh) {
+	std::uint64_t h = fnv_offset;
+	for (auto v : mesh->vertices()) {
+		const Point_3& p = mesh->point(v);
+		h = combine(combine(combine(h, p.x()), p.y()), p.z());
+	}
+	for (auto f : mesh->faces()) {
+		for (auto v : CGAL::vertices_around_face(mesh->halfedge(f), *mesh)) {
+			h = combine(h, double(v.idx()));
+		}
+		h = combine(h, -1.0);
+	}
+	return combine(combine(h, double(mesh->number_of_vertices())), double(mesh->number_of_faces()));
+}
+
+
+std::uint64_t StageCache::combine(std::uint64_t key, double parameter) {
+	std::uint64_t h = key;
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&parameter);
+	for (std::size_t i = 0; i < sizeof(parameter); ++i) {
+		h ^= bytes[i];
+		h *= fnv_prime;
+	}
+	return h;
+}
+
+
+std::string StageCache::file_name(std::uint64_t key, Stage stage) const {
+	std::ostringstream name;
+	name << directory_ << "/" << std::hex << std::setw(16) << std::setfill('0') << key << "." << stage_names[stage];
+	return name.str();
+}
+
+
+// PLANARITY //
+bool StageCache::load_planarity(std::uint64_t key, Mesh* mesh) {
+	Mapped_file mapped(file_name(key, PLANARITY));
+	if (!mapped.is_open()) { return false; }
+
+	Artifact_reader in(mapped.begin(), mapped.end());
+	if (!read_header(&in, PLANARITY, key, mesh)) { return false; }
+
+	std::vector<double> v_values, f_values;
+	for (std::size_t i = 0; i < mesh->number_of_vertices(); i++) { v_values.push_back(in.get<double>()); }
+	for (std::size_t i = 0; i < mesh->number_of_faces(); i++) { f_values.push_back(in.get<double>()); }
+	if (!in.at_end()) { return false; }
+
+	VProp_double v_planar = mesh->add_property_map<Vertex, double>("v:planarity", -9999).first;
+	FProp_double f_planar = mesh->add_property_map<Face, double>("f:planarity", 0.0).first;
+	std::size_t idx = 0;
+	for (auto v : mesh->vertices()) { v_planar[v] = v_values[idx++]; }
+	idx = 0;
+	for (auto f : mesh->faces()) { f_planar[f] = f_values[idx++]; }
+	return true;
+}
+
+
+bool StageCache::store_planarity(std::uint64_t key, const Mesh* mesh) {
+	VProp_double v_planar = mesh->property_map<Vertex, double>("v:planarity").value();
+	FProp_double f_planar = mesh->property_map<Face, double>("f:planarity").value();
+
+	return write_artifact(file_name(key, PLANARITY), [&](Buffered_writer* out) {
+		write_header(out, PLANARITY, key, mesh);
+		for (auto v : mesh->vertices()) { out->binary(v_planar[v]); }
+		for (auto f : mesh->faces()) { out->binary(f_planar[f]); }
+	});
+}
+// PLANARITY //
+
+
+// SEGMENTATION //
+bool StageCache::load_segmentation(std::uint64_t key, Mesh* mesh, std::size_t* seg_number) {
+	Mapped_file mapped(file_name(key, SEGMENTATION));
+	if (!mapped.is_open()) { return false; }
+
+	Artifact_reader in(mapped.begin(), mapped.end());
+	if (!read_header(&in, SEGMENTATION, key, mesh)) { return false; }
+
+	std::size_t num_segments = std::size_t(in.get<std::uint64_t>());
+	std::vector<int> charts;
+	std::vector<Point_3> colors;
+	for (std::size_t i = 0; i < mesh->number_of_faces(); i++) { charts.push_back(in.get<std::int32_t>()); }
+	for (std::size_t i = 0; i < mesh->number_of_faces(); i++) { colors.push_back(in.point()); }
+	if (!in.at_end()) { return false; }
+
+	FProp_int chart = mesh->add_property_map<Face, int>("f:chart", -1).first;
+	FProp_color color = mesh->add_property_map<Face, Point_3>("f:color", Point_3(0, 0, 0)).first;
+	std::size_t idx = 0;
+	for (auto f : mesh->faces()) {
+		chart[f] = charts[idx];
+		color[f] = colors[idx];
+		idx++;
+	}
+	*seg_number = num_segments;
+	return true;
+}
+
+
+bool StageCache::store_segmentation(std::uint64_t key, const Mesh* mesh, std::size_t seg_number) {
+	FProp_int chart = mesh->property_map<Face, int>("f:chart").value();
+	FProp_color color = mesh->property_map<Face, Point_3>("f:color").value();
+
+	return write_artifact(file_name(key, SEGMENTATION), [&](Buffered_writer* out) {
+		write_header(out, SEGMENTATION, key, mesh);
+		out->binary(std::uint64_t(seg_number));
+		for (auto f : mesh->faces()) { out->binary(std::int32_t(chart[f])); }
+		for (auto f : mesh->faces()) { write_point(out, color[f]); }
+	});
+}
+// SEGMENTATION //
+
+
+// STRUCTURE GRAPH //
+bool StageCache::load_structure_graph(std::uint64_t key, Mesh* mesh, Graph* G) {
+	Mapped_file mapped(file_name(key, STRUCTURE_GRAPH));
+	if (!mapped.is_open()) { return false; }
+
+	Artifact_reader in(mapped.begin(), mapped.end());
+	if (!read_header(&in, STRUCTURE_GRAPH, key, mesh)) { return false; }
+
+	std::vector<double> importance;
+	for (std::size_t i = 0; i < mesh->number_of_faces(); i++) { importance.push_back(in.get<double>()); }
+
+	Graph H;
+	std::size_t num_vertices = in.count(sizeof(std::uint32_t));
+	for (std::size_t i = 0; i < num_vertices; i++) { boost::add_vertex(GraphVertex{ in.get<std::uint32_t>() }, H); }
+	std::size_t num_edges = in.count(2 * sizeof(std::uint64_t));
+	for (std::size_t i = 0; i < num_edges; i++) {
+		std::uint64_t s = in.get<std::uint64_t>(), t = in.get<std::uint64_t>();
+		if (s >= num_vertices || t >= num_vertices) { return false; }
+		boost::add_edge(Graph_vertex(s), Graph_vertex(t), H);
+	}
+	if (!in.at_end()) { return false; }
+
+	FProp_double imp = mesh->add_property_map<Face, double>("f:imp", -1).first;
+	std::size_t idx = 0;
+	for (auto f : mesh->faces()) { imp[f] = importance[idx++]; }
+	*G = H;
+	return true;
+}
+
+
+bool StageCache::store_structure_graph(std::uint64_t key, const Mesh* mesh, const Graph* G) {
+	FProp_double imp = mesh->property_map<Face, double>("f:imp").value();
+
+	return write_artifact(file_name(key, STRUCTURE_GRAPH), [&](Buffered_writer* out) {
+		write_header(out, STRUCTURE_GRAPH, key, mesh);
+		for (auto f : mesh->faces()) { out->binary(imp[f]); }
+
+		out->binary(std::uint64_t(boost::num_vertices(*G)));
+		Graph_vertex_iterator vb, ve;
+		for (boost::tie(vb, ve) = vertices(*G); vb != ve; ++vb) {
+			out->binary(std::uint32_t((*G)[*vb].segment));
+		}
+		out->binary(std::uint64_t(boost::num_edges(*G)));
+		Graph_edge_iterator eb, ee;
+		for (boost::tie(eb, ee) = edges(*G); eb != ee; ++eb) {
+			out->binary(std::uint64_t(boost::source(*eb, *G)));
+			out->binary(std::uint64_t(boost::target(*eb, *G)));
+		}
+	});
+}
+// STRUCTURE GRAPH //
+
+
+// SCAFFOLD //
+bool StageCache::load_scaffold(std::uint64_t key, std::map<unsigned int, Plane_3>* plane_map, std::vector<Triple_intersection>* vertices,
+	                           std::vector<Plane_intersection>* edges, std::vector<Candidate_face>* faces) {
+	Mapped_file mapped(file_name(key, SCAFFOLD));
+	if (!mapped.is_open()) { return false; }
+
+	Artifact_reader in(mapped.begin(), mapped.end());
+	if (!read_header(&in, SCAFFOLD, key, nullptr)) { return false; }
+
+	// Supporting planes
+	std::map<unsigned int, Plane_3> planes;
+	std::size_t num_planes = in.count(sizeof(std::uint32_t) + 4 * sizeof(double));
+	for (std::size_t i = 0; i < num_planes; i++) {
+		unsigned int id = in.get<std::uint32_t>();
+		double a = in.get<double>(), b = in.get<double>(), c = in.get<double>(), d = in.get<double>();
+		planes[id] = Plane_3(a, b, c, d);
+	}
+
+	// Vertices
+	std::vector<Triple_intersection> scaffold_vertices(in.count(3 * sizeof(double)));
+	for (auto& vertex : scaffold_vertices) {
+		vertex.point = in.point();
+		in.ints(&vertex.planes);
+	}
+
+	// Edges
+	std::vector<Plane_intersection> scaffold_edges(in.count(6 * sizeof(double)));
+	for (auto& edge : scaffold_edges) {
+		Point_3 s = in.point(), t = in.point();
+		edge.segment = Segment_3(s, t);
+		in.ints(&edge.vertices);
+		in.ints(&edge.faces);
+		in.ints(&edge.planes);
+	}
+
+	// Candidate faces
+	std::vector<Candidate_face> candidate_faces(in.count(sizeof(std::uint64_t)));
+	for (auto& face : candidate_faces) {
+		std::size_t num_points = in.count(2 * sizeof(double));
+		for (std::size_t i = 0; i < num_points; i++) {
+			double x = in.get<double>(), y = in.get<double>();
+			face.polygon.push_back(Point_2(x, y));
+		}
+		in.ints(&face.vertices);
+		in.ints(&face.edges);
+		face.supporting_face_num = std::size_t(in.get<std::uint64_t>());
+		face.covered_area = in.get<double>();
+		face.area = in.get<double>();
+		face.data_distance = in.get<double>();
+		face.plane = in.get<std::int32_t>();
+	}
+	if (!in.at_end()) { return false; }
+
+	// Valid references
+	for (auto& edge : scaffold_edges) {
+		for (auto i : edge.vertices) { if (i < 0 || std::size_t(i) >= scaffold_vertices.size()) { return false; } }
+		for (auto j : edge.faces) { if (j < 0 || std::size_t(j) >= candidate_faces.size()) { return false; } }
+	}
+	for (auto& face : candidate_faces) {
+		for (auto i : face.vertices) { if (i < 0 || std::size_t(i) >= scaffold_vertices.size()) { return false; } }
+		for (auto e : face.edges) { if (e < 0 || std::size_t(e) >= scaffold_edges.size()) { return false; } }
+	}
+
+	plane_map->swap(planes);
+	vertices->swap(scaffold_vertices);
+	edges->swap(scaffold_edges);
+	faces->swap(candidate_faces);
+	return true;
+}
+
+
+bool StageCache::store_scaffold(std::uint64_t key, const std::map<unsigned int, Plane_3>* plane_map, const std::vector<Triple_intersection>* vertices,
+	                            const std::vector<Plane_intersection>* edges, const std::vector<Candidate_face>* faces) {
+	return write_artifact(file_name(key, SCAFFOLD), [&](Buffered_writer* out) {
+		write_header(out, SCAFFOLD, key, nullptr);
+
+		out->binary(std::uint64_t(plane_map->size()));
+		for (auto& pair : *plane_map) {
+			out->binary(std::uint32_t(pair.first));
+			out->binary(double(pair.second.a()));
+			out->binary(double(pair.second.b()));
+			out->binary(double(pair.second.c()));
+			out->binary(double(pair.second.d()));
+		}
+
+		out->binary(std::uint64_t(vertices->size()));
+		for (auto& vertex : *vertices) {
+			write_point(out, vertex.point);
+			write_ints(out, vertex.planes);
+		}
+
+		out->binary(std::uint64_t(edges->size()));
+		for (auto& edge : *edges) {
+			write_point(out, edge.segment.source());
+			write_point(out, edge.segment.target());
+			write_ints(out, edge.vertices);
+			write_ints(out, edge.faces);
+			write_ints(out, edge.planes);
+		}
+
+		out->binary(std::uint64_t(faces->size()));
+		for (auto& face : *faces) {
+			out->binary(std::uint64_t(face.polygon.size()));
+			for (auto p = face.polygon.vertices_begin(); p != face.polygon.vertices_end(); ++p) {
+				out->binary(double(p->x()));
+				out->binary(double(p->y()));
+			}
+			write_ints(out, face.vertices);
+			write_ints(out, face.edges);
+			out->binary(std::uint64_t(face.supporting_face_num));
+			out->binary(face.covered_area);
+			out->binary(face.area);
+			out->binary(face.data_distance);
+			out->binary(std::int32_t(face.plane));
+		}
+	});
+}
+// SCAFFOLD //
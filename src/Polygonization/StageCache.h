@@ -0,0 +1,69 @@
+/**
+ * MeshPolygonization is the implementation of the MVS (Multi-view Stereo) building mesh simplification method
+ * described in the following paper:
+ *      Vasileios Bouzas, Hugo Ledoux, and  Liangliang Nan.
+ *      Structure-aware Building Mesh Polygonization.
+ *      ISPRS Journal of Photogrammetry and Remote Sensing. 167(2020), 432-442, 2020.
+ * Please cite the above paper if you use the code/program (or part of it).
+ *
+ * LICENSE:
+ *      MeshPolygonization is free for academic use. If you are interested in a commercial license please contact
+ *      the 3D Geoinformation group.
+ *
+ * Copyright (C) 2019 3D Geoinformation Research Group
+ * https://3d.bk.tudelft.nl/
+ */
+
+#pragma once
+
+#include "Utils.h"
+
+#include <cstdint>
+
+
+// On-disk cache of stage outputs
+// Each stage is stored in <directory>/<key>.<stage>, where the key chains the hash of the input
+// (file or mesh) with the parameters of all the stages up to this one. Artifacts are little-endian binary
+// files, loaded through mmap. Mesh attributes are stored by vertex/face index, so they can only be
+// restored onto the same input mesh (checked by the key and the element counts).
+class StageCache
+{
+public:
+	enum Stage { PLANARITY, SEGMENTATION, STRUCTURE_GRAPH, SCAFFOLD };
+
+	StageCache(const std::string& directory);
+	~StageCache();
+
+	// Key of the input mesh, from its file content
+	static std::uint64_t hash_file(const std::string& file);
+
+	// Key of an in-memory input mesh, from its points and faces
+	static std::uint64_t hash_mesh(const Mesh* mesh);
+
+	// Key of the next stage, appending one of its parameters
+	static std::uint64_t combine(std::uint64_t key, double parameter);
+
+	// Planarity: v:planarity, f:planarity
+	bool load_planarity(std::uint64_t key, Mesh* mesh);
+	bool store_planarity(std::uint64_t key, const Mesh* mesh);
+
+	// Segmentation: f:chart, f:color and number of segments
+	bool load_segmentation(std::uint64_t key, Mesh* mesh, std::size_t* seg_number);
+	bool store_segmentation(std::uint64_t key, const Mesh* mesh, std::size_t seg_number);
+
+	// Structure graph and f:imp
+	bool load_structure_graph(std::uint64_t key, Mesh* mesh, Graph* G);
+	bool store_structure_graph(std::uint64_t key, const Mesh* mesh, const Graph* G);
+
+	// Scaffold: regularized segment planes, vertices, edges and candidate faces
+	bool load_scaffold(std::uint64_t key, std::map<unsigned int, Plane_3>* plane_map, std::vector<Triple_intersection>* vertices,
+		               std::vector<Plane_intersection>* edges, std::vector<Candidate_face>* faces);
+	bool store_scaffold(std::uint64_t key, const std::map<unsigned int, Plane_3>* plane_map, const std::vector<Triple_intersection>* vertices,
+		                const std::vector<Plane_intersection>* edges, const std::vector<Candidate_face>* faces);
+
+private:
+	std::string file_name(std::uint64_t key, Stage stage) const;
+
+private:
+	std::string directory_;
+};
@@ -34,16 +34,10 @@ if (NOT GUROBI_FOUND)
             )
 
     # Search for the headers and libraries
-    find_path(GUROBI_INCLUDE_DIR gurobi_c++.h
+    find_path(GUROBI_INCLUDE_DIR gurobi_c.h
             PATHS ${SEARCH_PATHS_FOR_HEADERS}
             )
 
-    find_library(GUROBI_CXX_LIBRARY
-            NAMES gurobi_c++
-            PATHS ${SEARCH_PATHS_FOR_LIBRARIES}
-            NO_DEFAULT_PATH
-            )
-
     find_library(GUROBI_C_LIBRARY
             NAMES gurobi120 gurobi
             PATHS ${SEARCH_PATHS_FOR_LIBRARIES}
@@ -52,7 +46,7 @@ if (NOT GUROBI_FOUND)
 
     # Set up the include directories and the libraries (without debug/optimized keywords)
     set(GUROBI_INCLUDE_DIRS ${GUROBI_INCLUDE_DIR})
-    set(GUROBI_LIBRARIES ${GUROBI_CXX_LIBRARY} ${GUROBI_C_LIBRARY})
+    set(GUROBI_LIBRARIES ${GUROBI_C_LIBRARY})
 endif ()
 
 # Check that Gurobi was successfully found
@@ -65,7 +59,5 @@ mark_as_advanced(
         GUROBI_INCLUDE_DIRS
         GUROBI_INCLUDE_DIR
         GUROBI_LIBRARIES
-        GUROBI_CXX_LIBRARY_DEBUG
-        GUROBI_CXX_LIBRARY_RELEASE
         GUROBI_C_LIBRARY
 )
@@ -32,6 +32,9 @@
 #           include( ../../cmake/UseCGAL.cmake )
 #
 # NOTE: this must be done after add_executable() or add_library()
+#
+# CGAL is linked to ${CGAL_TARGET} (defaults to ${PROJECT_NAME}), publicly so that
+# the targets using a library built on CGAL get its include directories as well.
 # ------------------------------------------------------------------------------
 
 #---------------------------------------------------------------------------------------------
@@ -41,6 +44,10 @@ if(POLICY CMP0074)
     cmake_policy(SET CMP0074 NEW)
 endif()
 
+if(NOT CGAL_TARGET)
+    set(CGAL_TARGET ${PROJECT_NAME})
+endif()
+
 find_package(CGAL REQUIRED COMPONENTS Core)
 if(CGAL_FOUND)
     message(STATUS "Found CGAL-${CGAL_MAJOR_VERSION}.${CGAL_MINOR_VERSION}.${CGAL_BUGFIX_VERSION}")
@@ -56,7 +63,7 @@ if(CGAL_FOUND)
     message(STATUS "   CGAL_3RD_PARTY_LIBRARIES: ${CGAL_3RD_PARTY_LIBRARIES}")
 
     # Link CGAL and its third-party libraries using the keyword signature.
-    target_link_libraries(${PROJECT_NAME} PRIVATE ${CGAL_LIBRARIES} ${CGAL_3RD_PARTY_LIBRARIES})
+    target_link_libraries(${CGAL_TARGET} PUBLIC ${CGAL_LIBRARIES} ${CGAL_3RD_PARTY_LIBRARIES})
 
 else()
     message(FATAL_ERROR "CGAL was not found.")
@@ -74,7 +81,7 @@ if(GMP_FOUND)
     message(STATUS "   GMP_INCLUDE_DIR: ${GMP_INCLUDE_DIR}")
     message(STATUS "   GMP_LIBRARIES: ${GMP_LIBRARIES}")
 
-    target_link_libraries(${PROJECT_NAME} PRIVATE ${GMP_LIBRARIES})
+    target_link_libraries(${CGAL_TARGET} PUBLIC ${GMP_LIBRARIES})
 else()
     message(FATAL_ERROR "GMP was not found.")
 endif()
@@ -91,7 +98,7 @@ if(MPFR_FOUND)
     message(STATUS "   MPFR_INCLUDE_DIR: ${MPFR_INCLUDE_DIR}")
     message(STATUS "   MPFR_LIBRARIES: ${MPFR_LIBRARIES}")
 
-    target_link_libraries(${PROJECT_NAME} PRIVATE ${MPFR_LIBRARIES})
+    target_link_libraries(${CGAL_TARGET} PUBLIC ${MPFR_LIBRARIES})
 else()
     message(FATAL_ERROR "MPFR was not found.")
 endif()
@@ -20,14 +20,44 @@
 #include <ctime>
 #include <cstdlib>
 #include <chrono>
+#include <memory>
+#include <sstream>
 
-#include "Planarity.h"
-#include "PlanarSegmentation.h"
-#include "StructureGraph.h"
+#include "Polygonizer.h"
 #include "Simplification.h"
+#include "FileReader.h"
 #include "FileWritter.h"
+#include "ParameterSweep.h"
+#include "Service.h"
+#include "Batch.h"
 
-#include <CGAL/Polygon_mesh_processing/IO/polygon_mesh_io.h>
+
+// Split list, e.g. "0.2,0.5"
+std::vector<std::string> split_list(const std::string& text, char separator) {
+	std::vector<std::string> items;
+	std::size_t pos = 0;
+	while (pos < text.size()) {
+		std::size_t next = text.find(separator, pos);
+		if (next == std::string::npos) { next = text.size(); }
+		if (next > pos) { items.push_back(text.substr(pos, next - pos)); }
+		pos = next + 1;
+	}
+	return items;
+}
+
+
+// Parse list of numbers, or the default value if empty
+template <typename T>
+std::vector<T> parse_list(const std::string& text, char separator, T default_value) {
+	std::vector<T> values;
+	for (auto& item : split_list(text, separator)) {
+		std::istringstream input(item);
+		T value;
+		if (input >> value) { values.push_back(value); }
+	}
+	if (values.empty() && text.empty()) { values.push_back(default_value); }
+	return values;
+}
 
 
 // int main(int argc, char *argv[]) {
@@ -45,10 +75,32 @@ int main(int argc, char *argv[]) {
         if (arg1 == "-h" || arg1 == "--help") {
             std::cout << "MeshPolygonization: Structure-aware Building Mesh Simplification" << std::endl;
             std::cout << "Usage:" << std::endl;
-            std::cout << "  " << argv[0] << " [input_model.off]" << std::endl << std::endl;
+            std::cout << "  " << argv[0] << " [input_model.off] [--solver <name>] [--export <name>] [--format <name>] [--polygons]" << std::endl;
+            std::cout << "  " << argv[0] << " --resume <name> <solution.sol>" << std::endl << std::endl;
             std::cout << "Arguments:" << std::endl;
             std::cout << "  input_model.off     Path to a 3D mesh in OFF format to polygonize." << std::endl;
             std::cout << "                      If omitted, defaults to: ../data/arc.off" << std::endl;
+            std::cout << "  --solver <name>     gurobi, scip, local_search, soplex, portfolio or highs" << std::endl;
+            std::cout << "                      (overrides the solver set in main.cpp)" << std::endl;
+            std::cout << "  --export <name>     Stop after building the face selection program and write it to" << std::endl;
+            std::cout << "                      <name>.mps and <name>.lp, with the candidate faces to <name>-candidates.off" << std::endl;
+            std::cout << "  --resume <name> <solution.sol>" << std::endl;
+            std::cout << "                      Assemble the result from exported candidate faces and a solution file" << std::endl;
+            std::cout << "                      (e.g., written by Gurobi or SCIP), skipping all geometry computation" << std::endl;
+            std::cout << "  --format <name>     Result format: ply (ASCII), ply_binary (little-endian) or obj" << std::endl;
+            std::cout << "  --polygons          Keep the planar faces as polygons instead of triangulating them" << std::endl;
+            std::cout << "  --sweep             Evaluate all combinations of the parameter grids below, reusing shared stages" << std::endl;
+            std::cout << "                      (results and metrics are written to <input>-sweep-<i> and <input>-sweep.csv)" << std::endl;
+            std::cout << "  --rings <list>      Orders of k-ring neighborhood, e.g. 2,3" << std::endl;
+            std::cout << "  --distance <list>   Distance thresholds, e.g. 0.2,0.5,0.8" << std::endl;
+            std::cout << "  --importance <list> Importance thresholds, e.g. 0,0.2,1" << std::endl;
+            std::cout << "  --weights <list>    Objective weights fitting:coverage:complexity, e.g. 0.43:0.27:0.30,0.5:0.25:0.25" << std::endl;
+            std::cout << "  --serve <socket>    Run as a service on a Unix domain socket, polygonizing the meshes of its requests" << std::endl;
+            std::cout << "                      with the parameters above as defaults (see Service.h, or scripts/polygonize_client.py)" << std::endl;
+            std::cout << "  --batch <path>      Polygonize all meshes of a directory (recursively) or listed in a manifest file" << std::endl;
+            std::cout << "                      (one path per line), sharing the cores among them; each result is written" << std::endl;
+            std::cout << "                      to <mesh>-result.<format>, and the record of each mesh to <path>-batch.csv" << std::endl;
+            std::cout << "  --workers <n>       Number of service workers, or cores of the batch (default: one per core)" << std::endl;
             std::cout << std::endl;
             std::cout << "Example:" << std::endl;
             std::cout << "  " << argv[0] << " /path/to/your_model.off" << std::endl;
@@ -56,26 +108,94 @@ int main(int argc, char *argv[]) {
         }
     }
 
-    // Get input file from CLI or fallback
-    if (argc >= 2) {
-        input_file = argv[1];
-    } else {
+    // Get input file and modes from CLI or fallback
+    std::string export_name, resume_name, solution_file, solver_option, format_option;
+    std::string rings_option, distance_option, importance_option, weights_option, socket_option, workers_option, batch_option;
+    bool keep_polygons = false, sweep = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (arg == "--export" && i + 1 < argc) {
+            export_name = argv[++i];
+        } else if (arg == "--solver" && i + 1 < argc) {
+            solver_option = argv[++i];
+        } else if (arg == "--format" && i + 1 < argc) {
+            format_option = argv[++i];
+        } else if (arg == "--polygons") {
+            keep_polygons = true;
+        } else if (arg == "--sweep") {
+            sweep = true;
+        } else if (arg == "--rings" && i + 1 < argc) {
+            rings_option = argv[++i];
+        } else if (arg == "--distance" && i + 1 < argc) {
+            distance_option = argv[++i];
+        } else if (arg == "--importance" && i + 1 < argc) {
+            importance_option = argv[++i];
+        } else if (arg == "--weights" && i + 1 < argc) {
+            weights_option = argv[++i];
+        } else if (arg == "--serve" && i + 1 < argc) {
+            socket_option = argv[++i];
+        } else if (arg == "--batch" && i + 1 < argc) {
+            batch_option = argv[++i];
+        } else if (arg == "--workers" && i + 1 < argc) {
+            workers_option = argv[++i];
+        } else if (arg == "--resume" && i + 2 < argc) {
+            resume_name = argv[++i];
+            solution_file = argv[++i];
+        } else {
+            input_file = arg;
+        }
+    }
+    if (input_file.empty()) {
         input_file = std::string(POLYGONIZATION_ROOT_DIR) + "/../data/arc.off";
     }
 
-    std::cout << "Input model: " << input_file << std::endl;
+    // Output inputs
+    Output_parameters output;
+    output.format = Output_parameters::PLY_ASCII;    // NOTE: you can modify this parameter here (PLY_ASCII, PLY_BINARY or OBJ)
+    output.triangulate = true;                       // NOTE: you can modify this parameter here
+    if (format_option == "ply") { output.format = Output_parameters::PLY_ASCII; }
+    else if (format_option == "ply_binary") { output.format = Output_parameters::PLY_BINARY; }
+    else if (format_option == "obj") { output.format = Output_parameters::OBJ; }
+    else if (!format_option.empty()) {
+        std::cerr << "Unknown result format '" << format_option << "' (ply, ply_binary or obj)" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (keep_polygons) { output.triangulate = false; }
 
-    // Read mesh
+    // Resume from an offline solution
+    if (!resume_name.empty()) {
+        std::cout << "Candidate faces: " << resume_name << "-candidates.off, solution: " << solution_file << std::endl;
+        Simplification simpl;
+        simpl.set_triangulation(output.triangulate);
+        Mesh simplified = simpl.resume(resume_name, solution_file);
+        if (simplified.number_of_faces() == 0) {
+            std::cerr << "No polygonal surface was obtained" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        const std::string result_file = resume_name + "-result" + output_extension(output.format);
+        if (!writeSimplified(&simplified, result_file, output.format)) { return EXIT_FAILURE; }
+        std::cout << "Done. Result saved to file \'" << result_file << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    // Read mesh (the service and the batch read their own meshes)
 	Mesh mesh;
-    if (CGAL::Polygon_mesh_processing::IO::read_polygon_mesh(input_file, mesh) == false) {
-	    std::cerr << "Failed to load input model from file \'" << input_file << "\'." << std::endl;
-	    return EXIT_FAILURE;
-	}
+    if (socket_option.empty() && batch_option.empty()) {
+        std::cout << "Input model: " << input_file << std::endl;
+        if (readMesh(input_file, &mesh) == false) {
+            std::cerr << "Failed to load input model from file \'" << input_file << "\'." << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Pipeline configuration
+    PolygonizerConfig config;
 
     // Planarity inputs
-	unsigned int num_rings = 3;
+	config.num_rings = 3;
 	/*std::cout << "Insert order of k-ring neighborhood: ";
-	std::cin >> num_rings;*/
+	std::cin >> config.num_rings;*/
 
     std::cout << "----------------------------------------------------------------" << std::endl;
     std::cout << "------- Parameters (You may need to modify some of them) -------" << std::endl;
@@ -93,68 +213,191 @@ int main(int argc, char *argv[]) {
 	}
     dist_threshold /= mesh.num_edges();
 #endif
-    std::cout << "\tDistance threshold: " << std::setprecision(2) << dist_threshold << std::endl;
+    config.set_distance_threshold(dist_threshold);
+    std::cout << "\tDistance threshold: " << std::setprecision(2) << config.dist_threshold << std::endl;
 
 	// StructureGraph inputs
-	double importance_threshold = 0.0;    // NOTE: you can modify this parameter here
-	std::cout << "\tImportance threshold: " << std::setprecision(2) << importance_threshold << std::endl;
+	config.importance_threshold = 0.0;    // NOTE: you can modify this parameter here
+	std::cout << "\tImportance threshold: " << std::setprecision(2) << config.importance_threshold << std::endl;
+
+	// Regularization inputs
+	Regularization_parameters& regularization = config.regularization;
+	regularization.enabled = false;                             // NOTE: you can modify this parameter here (snaps planes to common orientations and merges coplanar ones)
+	regularization.angle_tolerance = 3.0;                       // NOTE: you can modify this parameter here (degrees)
+	regularization.distance_tolerance = 0.5 * dist_threshold;   // NOTE: you can modify this parameter here
+	if (regularization.enabled) {
+		std::cout << "\tRegularization: " << std::setprecision(2) << regularization.angle_tolerance << " degrees, "
+		          << regularization.distance_tolerance << " offset" << std::endl;
+	} else {
+		std::cout << "\tRegularization: off" << std::endl;
+	}
+
+	// Pruning inputs
+	Pruning_parameters& pruning = config.pruning;
+	pruning.enabled = false;                  // NOTE: you can modify this parameter here (may remove unsupported closing faces, e.g. the ground)
+	pruning.min_coverage = 0.01;              // NOTE: you can modify this parameter here
+	pruning.min_support = 1;                  // NOTE: you can modify this parameter here
+	pruning.max_distance = dist_threshold;    // NOTE: you can modify this parameter here
+	if (pruning.enabled) {
+		std::cout << "\tPruning: coverage < " << std::setprecision(2) << pruning.min_coverage << ", support < " << pruning.min_support
+		          << ", distance > " << pruning.max_distance << std::endl;
+	} else {
+		std::cout << "\tPruning: off" << std::endl;
+	}
+
+	// Optimization inputs
+	Optimization_parameters& optimization = config.optimization;
+	optimization.lazy_constraints = true;     // NOTE: you can modify this parameter here
+	std::cout << "\tLazy constraints: " << (optimization.lazy_constraints ? "yes" : "no") << std::endl;
+	optimization.budget.time_limit = -1.0;       // NOTE: you can modify this parameter here (seconds, shared by all components, negative for no limit)
+	optimization.budget.node_limit = -1;         // NOTE: you can modify this parameter here (per component, negative for no limit)
+	optimization.budget.relative_gap = 1e-4;     // NOTE: you can modify this parameter here
+	optimization.budget.num_threads = 0;         // NOTE: you can modify this parameter here (0 for all cores)
+	optimization.cache_directory = "";           // NOTE: you can modify this parameter here (e.g., "solutions", empty to disable)
+	std::cout << "\tSolver budget: time limit " << optimization.budget.time_limit << " secs, node limit " << optimization.budget.node_limit
+	          << ", gap " << optimization.budget.relative_gap << std::endl;
+	if (!optimization.cache_directory.empty()) { std::cout << "\tSolution cache: " << optimization.cache_directory << std::endl; }
+	optimization.report_file = "";               // NOTE: you can modify this parameter here (e.g., "solver_report.jsonl", empty to disable)
+	if (!optimization.report_file.empty()) { std::cout << "\tSolver telemetry: " << optimization.report_file << std::endl; }
 
-    auto solver = LinearProgramSolver::GUROBI;    // NOTE: you can modify this parameter here (available solvers are Gurobi and SCIP)
+	// Stage cache inputs
+	config.stage_cache_directory = "";        // NOTE: you can modify this parameter here (e.g., "stages", empty to disable)
+	if (!config.stage_cache_directory.empty()) { std::cout << "\tStage cache: " << config.stage_cache_directory << std::endl; }
+
+    config.solver = LinearProgramSolver::GUROBI;    // NOTE: you can modify this parameter here (available solvers are Gurobi, SCIP, LOCAL_SEARCH, SOPLEX, PORTFOLIO and HIGHS)
+    const char* solver_names[] = { "Gurobi", "SCIP", "Local search", "SoPlex (LP relaxation)", "Portfolio", "HiGHS" };
+    const char* solver_options[] = { "gurobi", "scip", "local_search", "soplex", "portfolio", "highs" };
+    bool solver_known = solver_option.empty();
+    for (int i = 0; i < 6; i++) {
+        if (solver_option == solver_options[i]) { config.solver = static_cast<LinearProgramSolver::SolverName>(i); solver_known = true; }
+    }
+    if (!solver_known) {
+        std::cerr << "Unknown solver \'" << solver_option << "\' (gurobi, scip, local_search, soplex, portfolio or highs)" << std::endl;
+        return EXIT_FAILURE;
+    }
 #ifdef HAS_GUROBI
-    std::cout << "\tSolver: " << (solver == LinearProgramSolver::GUROBI ? "Gurobi" : "SCIP") << " " << std::endl;
+    std::cout << "\tSolver: " << solver_names[config.solver] << (config.solver == LinearProgramSolver::SCIP ? " (Not available, use local search instead)" : "") << " " << std::endl;
 #else
-    std::cout << "\tSolver requested: " << (solver == LinearProgramSolver::GUROBI ? "Gurobi (Not available, use SCIP instead)" : "SCIP") << " " << std::endl;
+    std::cout << "\tSolver requested: " << solver_names[config.solver] << (config.solver == LinearProgramSolver::GUROBI || config.solver == LinearProgramSolver::SCIP ? " (Not available, use local search instead)" : "") << " " << std::endl;
 #endif
 
+    config.triangulate = output.triangulate;
+    config.program_export = export_name;
+
     std::cout << "----------------------------------------------------------------" << std::endl;
     std::cout << "----------------------------------------------------------------" << std::endl;
 
-    // Calculate planarity
+    // Service, requests default to the parameters above
+    if (!socket_option.empty()) {
+        Service_parameters service;
+        service.socket_path = socket_option;
+        service.num_workers = 0;               // NOTE: you can modify this parameter here (0 for one per core)
+        service.threads_per_worker = 0;        // NOTE: you can modify this parameter here (0 to share the cores among the workers)
+        service.max_queue = 64;                // NOTE: you can modify this parameter here (requests waiting for a worker)
+        service.block_when_full = false;       // NOTE: you can modify this parameter here (wait instead of refusing when the queue is full)
+        service.max_connections = 64;          // NOTE: you can modify this parameter here
+        service.file_root = "";                // NOTE: you can modify this parameter here (directory of the file/output paths of the requests, empty to refuse them)
+        if (!workers_option.empty()) { std::istringstream(workers_option) >> service.num_workers; }
+
+        Service polygonization_service(config, service);
+        return polygonization_service.run() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Batch, all meshes with the parameters above
+    if (!batch_option.empty()) {
+        Batch_parameters batch;
+        batch.num_threads = 0;                 // NOTE: you can modify this parameter here (0 for all cores)
+        batch.faces_per_thread = 20000;        // NOTE: you can modify this parameter here (a mesh gets one core per this many faces)
+        batch.max_threads_per_building = 0;    // NOTE: you can modify this parameter here (0 for no limit)
+        batch.output_directory = "";           // NOTE: you can modify this parameter here (empty to write the results next to the meshes)
+        batch.format = output.format;
+        if (!workers_option.empty()) { std::istringstream(workers_option) >> batch.num_threads; }
+
+        std::vector<std::string> files = Batch::collect_files(batch_option);
+        std::cout << "Batch: " << files.size() << " meshes from \'" << batch_option << "\'" << std::endl;
+        if (files.empty()) { return EXIT_FAILURE; }
+
+        Batch polygonization_batch(config, batch);
+        std::vector<Batch_record> records = polygonization_batch.run(files);
+
+        std::string report_file = batch_option;
+        while (report_file.size() > 1 && (report_file.back() == '/' || report_file.back() == '\\')) { report_file.pop_back(); }
+        Batch::report(&records, report_file + "-batch.csv");
+        for (auto& record : records) {
+            if (!record.success) { return EXIT_FAILURE; }
+        }
+        return EXIT_SUCCESS;
+    }
+
+    // Parameter sweep, the grids default to the parameters above
+    if (sweep) {
+        Sweep_parameters grid;
+        grid.num_rings = parse_list<unsigned int>(rings_option, ',', config.num_rings);
+        grid.distance_thresholds = parse_list<double>(distance_option, ',', config.dist_threshold);
+        grid.importance_thresholds = parse_list<double>(importance_option, ',', config.importance_threshold);
+        grid.weights.clear();
+        for (auto& item : split_list(weights_option, ',')) {
+            std::vector<double> w = parse_list<double>(item, ':', 0.0);
+            if (w.size() != 3) { std::cerr << "Invalid objective weights \'" << item << "\'" << std::endl; return EXIT_FAILURE; }
+            Objective_weights weights;
+            weights.fitting = w[0]; weights.coverage = w[1]; weights.complexity = w[2];
+            grid.weights.push_back(weights);
+        }
+        if (grid.weights.empty()) { grid.weights.push_back(optimization.weights); }
+        grid.regularization_distance_ratio = regularization.distance_tolerance / config.dist_threshold;
+        grid.pruning_distance_ratio = pruning.max_distance / config.dist_threshold;
+        grid.output_prefix = input_file + "-sweep";
+
+        auto start = std::chrono::steady_clock::now();
+        ParameterSweep parameter_sweep;
+        std::vector<Sweep_result> results = parameter_sweep.run(&mesh, grid, regularization, pruning, optimization, output, config.solver);
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        ParameterSweep::report(&results, input_file + "-sweep.csv");
+        std::cout << "Sweep: " << std::setprecision(1) << std::fixed << duration.count() / 1000.0 << " secs" << std::endl;
+        std::size_t num_succeeded = 0;
+        for (const auto& result : results) {
+            if (result.success) { num_succeeded++; }
+        }
+        if (num_succeeded == 0) {
+            std::cerr << "No combination of the sweep obtained a polygonal surface" << std::endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+	// Polygonize
 	auto start = std::chrono::steady_clock::now();
-	Planarity plan;
-	plan.compute(&mesh, num_rings);
-	// Execution time
-	auto end = std::chrono::steady_clock::now();
-	auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-	std::cout << "Planarity: " << std::setprecision(1) << duration.count() / 1000.0 << " secs" << std::endl;
-
-	// Initialize segmentation
-	start = std::chrono::steady_clock::now();
-	PlanarSegmentation seg;
-	std::size_t seg_number = seg.apply(&mesh, dist_threshold, num_rings);
-	// Execution time
-	end = std::chrono::steady_clock::now();
-	duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-	std::cout << "Segmentation: " << std::setprecision(1) << duration.count() / 1000.0 << " secs" << std::endl;
-
-	// StructureGraph
-	start = std::chrono::steady_clock::now();
-	StructureGraph graph;
-	Graph structure_graph = graph.construct(&mesh, seg_number, importance_threshold);
-	// Execution time
-	end = std::chrono::steady_clock::now();
-	duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-	std::cout << "Structure Graph: " << std::setprecision(1) << duration.count() / 1000.0 << " secs" << std::endl;
+	Polygonizer polygonizer(config);
+	PolygonizerResult result = polygonizer.apply(&mesh);
+	auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+	std::cout << "Simplification: " << std::setprecision(1) << std::fixed << result.stats.scaffold_time + result.stats.selection_time
+	          << " secs" << std::defaultfloat << std::endl;
+	std::cout << "Polygonization: " << std::setprecision(1) << std::fixed << duration.count() / 1000.0 << " secs ("
+	          << result.stats.num_segments << " segments, " << result.stats.num_planes << " planes, "
+	          << result.stats.num_candidates << " candidate faces)" << std::defaultfloat << std::endl;
 
 	// Write the mesh with computed face/vertex properties
 //	writeMesh(&mesh, input_file + "-segmentation.ply");
 
-	// Write graph
-//	writeGraph(&mesh, &structure_graph, input_file + "-graph.obj");
+	// Program exported, solved offline
+	if (!export_name.empty()) {
+		if (!result.program_exported) {
+			std::cerr << "Failed to export the program to \'" << export_name << "\'" << std::endl;
+			return EXIT_FAILURE;
+		}
+		std::cout << "Done. Resume with: " << argv[0] << " --resume " << export_name << " <solution.sol>" << std::endl;
+		return EXIT_SUCCESS;
+	}
 
-	// Simplification
-	start = std::chrono::steady_clock::now();
-	Simplification simpl;
-	Mesh simplified = simpl.apply(&mesh, &structure_graph, solver);
-	// Execution time
-	end = std::chrono::steady_clock::now();
-	duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-	std::cout << "Simplification: " << std::setprecision(1) << duration.count() / 1000.0 << " secs" << std::endl;
+	if (!result.success) {
+		std::cerr << "No polygonal surface was obtained" << std::endl;
+		return EXIT_FAILURE;
+	}
 
 	// Write simplified mesh
-	const std::string result_file = input_file + "-result.ply";
-	writeSimplified(&simplified, result_file);
+	const std::string result_file = input_file + "-result" + output_extension(output.format);
+	if (!writeSimplified(&result.mesh, result_file, output.format)) { return EXIT_FAILURE; }
 	std::cout << "Done. Result saved to file \'" << result_file << std::endl;
 
 	return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
@@ -0,0 +1,161 @@
+/*
+Copyright (C) 2017  Liangliang Nan
+https://3d.bk.tudelft.nl/liangliang/ - liangliang.nan@gmail.com
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+
+#include "columnar_program.h"
+
+#include <map>
+
+
+void ColumnarProgram::reserve(std::size_t num_variables, std::size_t num_constraints, std::size_t num_nonzeros) {
+	lower_.reserve(num_variables);
+	upper_.reserve(num_variables);
+	types_.reserve(num_variables);
+	objective_.reserve(num_variables);
+
+	row_start_.reserve(num_constraints + 1);
+	row_lower_.reserve(num_constraints);
+	row_upper_.reserve(num_constraints);
+	lazy_.reserve(num_constraints);
+
+	columns_.reserve(num_nonzeros);
+	values_.reserve(num_nonzeros);
+}
+
+
+std::size_t ColumnarProgram::add_variables(std::size_t n, VariableType type, double lb, double ub) {
+	std::size_t first = lower_.size();
+	if (type == BINARY) {
+		lb = 0.0;
+		ub = 1.0;
+	}
+	lower_.resize(first + n, lb);
+	upper_.resize(first + n, ub);
+	types_.resize(first + n, static_cast<char>(type));
+	objective_.resize(first + n, 0.0);
+	return first;
+}
+
+
+std::size_t ColumnarProgram::add_constraint(double lb, double ub, bool lazy) {
+	row_start_.push_back(row_start_.back());
+	row_lower_.push_back(lb);
+	row_upper_.push_back(ub);
+	lazy_.push_back(lazy ? 1 : 0);
+	return row_lower_.size() - 1;
+}
+
+
+void ColumnarProgram::assign(const LinearProgram* program) {
+	clear();
+
+	const std::vector<Variable*>& variables = program->variables();
+	const std::vector<LinearConstraint*>& constraints = program->constraints();
+	std::size_t num_nonzeros = 0;
+	for (std::size_t i = 0; i < constraints.size(); ++i)
+		num_nonzeros += constraints[i]->coefficients().size();
+	reserve(variables.size(), constraints.size(), num_nonzeros);
+
+	for (std::size_t i = 0; i < variables.size(); ++i) {
+		const Variable* var = variables[i];
+		double lb, ub;
+		var->get_bounds(lb, ub);
+
+		VariableType type = CONTINUOUS;
+		if (var->variable_type() == Variable::INTEGER)
+			type = INTEGER;
+		else if (var->variable_type() == Variable::BINARY)
+			type = BINARY;
+		add_variables(1, type, lb, ub);
+	}
+
+	const LinearObjective* objective = program->objective();
+	sense_ = objective->sense();
+	const std::unordered_map<int, double>& obj_coeffs = objective->coefficients();
+	std::unordered_map<int, double>::const_iterator it = obj_coeffs.begin();
+	for (; it != obj_coeffs.end(); ++it)
+		objective_[it->first] = it->second;
+
+	for (std::size_t i = 0; i < constraints.size(); ++i) {
+		const LinearConstraint* c = constraints[i];
+		double lb = -Variable::infinity();
+		double ub = +Variable::infinity();
+		switch (c->bound_type())
+		{
+		case LinearConstraint::FIXED:
+			lb = ub = c->get_bound();
+			break;
+		case LinearConstraint::LOWER:
+			lb = c->get_bound();
+			break;
+		case LinearConstraint::UPPER:
+			ub = c->get_bound();
+			break;
+		case LinearConstraint::DOUBLE:
+			c->get_bounds(lb, ub);
+			break;
+		default:
+			break;
+		}
+		add_constraint(lb, ub, c->is_lazy());
+
+		// sorted columns
+		const std::unordered_map<int, double>& coeffs = c->coefficients();
+		std::map<int, double> sorted(coeffs.begin(), coeffs.end());
+		std::map<int, double>::const_iterator cur = sorted.begin();
+		for (; cur != sorted.end(); ++cur)
+			add_coefficient(cur->first, cur->second);
+	}
+
+	mip_start_ = program->mip_start();
+}
+
+
+void ColumnarProgram::clear() {
+	lower_.clear();
+	upper_.clear();
+	types_.clear();
+	objective_.clear();
+	sense_ = LinearObjective::MINIMIZE;
+
+	row_start_.assign(1, 0);
+	columns_.clear();
+	values_.clear();
+	row_lower_.clear();
+	row_upper_.clear();
+	lazy_.clear();
+
+	mip_start_.clear();
+}
+
+
+std::size_t ColumnarProgram::num_lazy_constraints() const {
+	std::size_t num_lazy = 0;
+	for (std::size_t i = 0; i < lazy_.size(); ++i)
+		num_lazy += lazy_[i] ? 1 : 0;
+	return num_lazy;
+}
+
+
+bool ColumnarProgram::is_violated(std::size_t i, const double* solution, double epsilon) const {
+	double value = 0.0;
+	for (int j = row_start_[i]; j < row_start_[i + 1]; ++j)
+		value += values_[j] * solution[columns_[j]];
+	return value < row_lower_[i] - epsilon || value > row_upper_[i] + epsilon;
+}
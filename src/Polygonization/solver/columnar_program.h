@@ -0,0 +1,109 @@
+/*
+Copyright (C) 2017  Liangliang Nan
+https://3d.bk.tudelft.nl/liangliang/ - liangliang.nan@gmail.com
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+
+#ifndef _MATH_COLUMNAR_PROGRAM_H_
+#define _MATH_COLUMNAR_PROGRAM_H_
+
+#include "linear_program.h"
+
+#include <vector>
+
+
+// A linear program stored in contiguous arrays: variable bounds, types and objective
+// coefficients, and the constraint matrix in compressed sparse row (CSR) format.
+// Unlike LinearProgram, no object is allocated per variable or per constraint, and
+// the arrays can be passed to the solvers as they are.
+class ColumnarProgram
+{
+public:
+	// Variable types, with the same codes as Gurobi
+	enum VariableType { CONTINUOUS = 'C', INTEGER = 'I', BINARY = 'B' };
+
+public:
+	ColumnarProgram() : sense_(LinearObjective::MINIMIZE) { row_start_.push_back(0); }
+	~ColumnarProgram() {}
+
+	// Reserves memory, to be called before adding variables and constraints.
+	void reserve(std::size_t num_variables, std::size_t num_constraints, std::size_t num_nonzeros);
+
+	// Adds n variables and returns the index of the first one.
+	std::size_t add_variables(std::size_t n, VariableType type, double lb, double ub);
+
+	void set_objective_coefficient(std::size_t var, double coeff) { objective_[var] = coeff; }
+	void set_sense(LinearObjective::Sense sense) { sense_ = sense; }
+
+	// Starts a new constraint lb <= sum coeff * x <= ub and returns its index.
+	// The coefficients are then appended with add_coefficient().
+	// Use -Variable::infinity() or +Variable::infinity() for single sided constraints.
+	std::size_t add_constraint(double lb, double ub, bool lazy = false);
+	void add_coefficient(int var, double coeff) { columns_.push_back(var); values_.push_back(coeff); ++row_start_.back(); }
+
+	// Provide a (feasible) solution to start from.
+	void set_mip_start(const std::vector<double>& values) { mip_start_ = values; }
+
+	// Converts a program. Coefficients of the same variable are accumulated.
+	void assign(const LinearProgram* program);
+
+	void clear();
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::size_t num_variables() const { return lower_.size(); }
+	std::size_t num_constraints() const { return row_lower_.size(); }
+	std::size_t num_nonzeros() const { return values_.size(); }
+	std::size_t num_lazy_constraints() const;
+
+	const std::vector<double>& lower_bounds() const { return lower_; }
+	const std::vector<double>& upper_bounds() const { return upper_; }
+	const std::vector<char>& types() const { return types_; }
+	const std::vector<double>& objective() const { return objective_; }
+	LinearObjective::Sense sense() const { return sense_; }
+
+	// Constraint i holds the entries row_start()[i] ... row_start()[i + 1] - 1
+	const std::vector<int>& row_start() const { return row_start_; }
+	const std::vector<int>& columns() const { return columns_; }
+	const std::vector<double>& values() const { return values_; }
+	const std::vector<double>& row_lower_bounds() const { return row_lower_; }
+	const std::vector<double>& row_upper_bounds() const { return row_upper_; }
+	const std::vector<char>& lazy() const { return lazy_; }
+
+	const std::vector<double>& mip_start() const { return mip_start_; }
+
+	// Returns true if constraint i is violated by a solution
+	bool is_violated(std::size_t i, const double* solution, double epsilon = 1e-6) const;
+
+private:
+	std::vector<double> lower_;
+	std::vector<double> upper_;
+	std::vector<char>	types_;
+	std::vector<double> objective_;
+	LinearObjective::Sense sense_;
+
+	std::vector<int>	row_start_;
+	std::vector<int>	columns_;
+	std::vector<double> values_;
+	std::vector<double> row_lower_;
+	std::vector<double> row_upper_;
+	std::vector<char>	lazy_;
+
+	std::vector<double> mip_start_;
+};
+
+#endif
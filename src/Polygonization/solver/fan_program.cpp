@@ -0,0 +1,386 @@
+/*
+Copyright (C) 2017  Liangliang Nan
+https://3d.bk.tudelft.nl/liangliang/ - liangliang.nan@gmail.com
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+
+#include "fan_program.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+void FanProgram::clear() {
+	num_variables_ = 0;
+	sense_sign_ = 1.0;
+	free_cost_ = 0.0;
+	face_variables_.clear();
+	edge_variables_.clear();
+	free_variables_.clear();
+	free_costs_.clear();
+	costs_.clear();
+	fans_.clear();
+	face_fans_.clear();
+}
+
+
+bool FanProgram::extract(const ColumnarProgram* program) {
+	clear();
+
+	num_variables_ = program->num_variables();
+	const std::vector<char>& types = program->types();
+	for (std::size_t i = 0; i < num_variables_; ++i) {
+		if (types[i] != ColumnarProgram::BINARY)
+			return false;
+	}
+
+	// role: 0 - free, 1 - face, 2 - edge
+	std::vector<int> role(num_variables_, 0);
+	std::vector<int> face_index(num_variables_, -1);
+
+	const double epsilon = 1e-10;
+	const std::vector<int>& row_start = program->row_start();
+	const std::vector<int>& columns = program->columns();
+	const std::vector<double>& values = program->values();
+	for (std::size_t i = 0; i < program->num_constraints(); ++i) {
+		if (std::abs(program->row_lower_bounds()[i]) > epsilon || std::abs(program->row_upper_bounds()[i]) > epsilon)
+			return false;
+
+		int edge_var = -1;
+		std::vector<std::size_t> fan;
+		for (int j = row_start[i]; j < row_start[i + 1]; ++j) {
+			int var_idx = columns[j];
+			double coeff = values[j];
+			if (std::abs(coeff + 2.0) < epsilon && edge_var == -1)
+				edge_var = var_idx;
+			else if (std::abs(coeff - 1.0) < epsilon && role[var_idx] != 2) {
+				if (role[var_idx] == 0) {
+					role[var_idx] = 1;
+					face_index[var_idx] = static_cast<int>(face_variables_.size());
+					face_variables_.push_back(var_idx);
+				}
+				fan.push_back(face_index[var_idx]);
+			}
+			else
+				return false;
+		}
+
+		// each edge variable belongs to a single fan
+		if (edge_var == -1 || role[edge_var] != 0)
+			return false;
+		role[edge_var] = 2;
+
+		std::sort(fan.begin(), fan.end());
+		fans_.push_back(fan);
+		edge_variables_.push_back(edge_var);
+	}
+
+	// objective, always minimized
+	sense_sign_ = (program->sense() == LinearObjective::MAXIMIZE) ? -1.0 : 1.0;
+	std::vector<double> var_costs(program->objective());
+	for (std::size_t i = 0; i < num_variables_; ++i)
+		var_costs[i] *= sense_sign_;
+
+	// an edge variable is fully determined by its fan, so it must not carry a cost
+	for (std::size_t k = 0; k < edge_variables_.size(); ++k) {
+		if (std::abs(var_costs[edge_variables_[k]]) > epsilon)
+			return false;
+	}
+
+	costs_.resize(face_variables_.size());
+	for (std::size_t f = 0; f < face_variables_.size(); ++f)
+		costs_[f] = var_costs[face_variables_[f]];
+
+	for (std::size_t i = 0; i < num_variables_; ++i) {
+		if (role[i] != 0)
+			continue;
+		free_variables_.push_back(i);
+		free_costs_.push_back(var_costs[i]);
+		if (var_costs[i] < 0.0)
+			free_cost_ += var_costs[i];
+	}
+
+	face_fans_.resize(face_variables_.size());
+	for (std::size_t k = 0; k < fans_.size(); ++k) {
+		for (std::size_t j = 0; j < fans_[k].size(); ++j)
+			face_fans_[fans_[k][j]].push_back(k);
+	}
+
+	return true;
+}
+
+
+bool FanProgram::is_feasible(const std::vector<char>& selected) const {
+	for (std::size_t k = 0; k < fans_.size(); ++k) {
+		int count = 0;
+		for (std::size_t j = 0; j < fans_[k].size(); ++j)
+			count += selected[fans_[k][j]] ? 1 : 0;
+		if (count != 0 && count != 2)
+			return false;
+	}
+	return true;
+}
+
+
+double FanProgram::objective_value(const std::vector<char>& selected) const {
+	double value = free_cost_;
+	for (std::size_t f = 0; f < costs_.size(); ++f) {
+		if (selected[f])
+			value += costs_[f];
+	}
+	return sense_sign_ * value;
+}
+
+
+std::vector<double> FanProgram::to_solution(const std::vector<char>& selected) const {
+	std::vector<double> solution(num_variables_, 0.0);
+
+	for (std::size_t f = 0; f < face_variables_.size(); ++f)
+		solution[face_variables_[f]] = selected[f] ? 1.0 : 0.0;
+
+	for (std::size_t k = 0; k < fans_.size(); ++k) {
+		int count = 0;
+		for (std::size_t j = 0; j < fans_[k].size(); ++j)
+			count += selected[fans_[k][j]] ? 1 : 0;
+		solution[edge_variables_[k]] = (count == 2) ? 1.0 : 0.0;
+	}
+
+	for (std::size_t i = 0; i < free_variables_.size(); ++i)
+		solution[free_variables_[i]] = (free_costs_[i] < 0.0) ? 1.0 : 0.0;
+
+	return solution;
+}
+
+
+std::vector<char> FanProgram::to_selection(const std::vector<double>& solution) const {
+	std::vector<char> selected(face_variables_.size(), 0);
+	for (std::size_t f = 0; f < face_variables_.size(); ++f)
+		selected[f] = (std::round(solution[face_variables_[f]]) > 0.5) ? 1 : 0;
+	return selected;
+}
+
+
+bool FanProgram::close_patch(std::size_t seed, std::vector<char>* selected, std::vector<int>* count, std::vector<std::size_t>* added) const {
+	return close_patch(seed, costs_, selected, count, added);
+}
+
+
+bool FanProgram::close_patch(std::size_t seed, const std::vector<double>& costs, std::vector<char>* selected, std::vector<int>* count, std::vector<std::size_t>* added) const {
+	std::vector<std::size_t> open;	// fans holding a single selected face
+
+	(*selected)[seed] = 1;
+	added->push_back(seed);
+	bool overfilled = false;
+	for (std::size_t j = 0; j < face_fans_[seed].size(); ++j) {
+		std::size_t k = face_fans_[seed][j];
+		int c = ++(*count)[k];
+		if (c == 1)
+			open.push_back(k);
+		else if (c > 2)
+			overfilled = true;
+	}
+	if (overfilled)
+		return false;
+
+	return close_fans(&open, costs, selected, count, added);
+}
+
+
+bool FanProgram::close_fans(std::vector<std::size_t>* open, const std::vector<double>& costs, std::vector<char>* selected, std::vector<int>* count, std::vector<std::size_t>* added) const {
+	for (std::size_t head = 0; head < open->size(); ++head) {
+		std::size_t k = (*open)[head];
+		if ((*count)[k] != 1)
+			continue;
+
+		// the cheapest face closing this fan without overfilling any other fan
+		int best = -1;
+		for (std::size_t j = 0; j < fans_[k].size(); ++j) {
+			std::size_t f = fans_[k][j];
+			if ((*selected)[f])
+				continue;
+
+			bool fits = true;
+			for (std::size_t l = 0; l < face_fans_[f].size(); ++l) {
+				if ((*count)[face_fans_[f][l]] > 1) {
+					fits = false;
+					break;
+				}
+			}
+			if (fits && (best == -1 || costs[f] < costs[best]))
+				best = static_cast<int>(f);
+		}
+		if (best == -1)
+			return false;
+
+		(*selected)[best] = 1;
+		added->push_back(best);
+		for (std::size_t l = 0; l < face_fans_[best].size(); ++l) {
+			std::size_t adj = face_fans_[best][l];
+			if (++(*count)[adj] == 1)
+				open->push_back(adj);
+		}
+	}
+
+	return true;
+}
+
+
+void FanProgram::drop_open_fans(std::vector<std::size_t>* open, std::vector<char>* selected, std::vector<int>* count, std::vector<std::size_t>* removed) const {
+	while (!open->empty()) {
+		std::size_t k = open->back();
+		open->pop_back();
+		if ((*count)[k] == 0 || (*count)[k] == 2)
+			continue;
+
+		for (std::size_t j = 0; j < fans_[k].size(); ++j) {
+			std::size_t f = fans_[k][j];
+			if (!(*selected)[f])
+				continue;
+
+			(*selected)[f] = 0;
+			removed->push_back(f);
+			for (std::size_t l = 0; l < face_fans_[f].size(); ++l) {
+				std::size_t adj = face_fans_[f][l];
+				--(*count)[adj];
+				if (adj != k && (*count)[adj] == 1)
+					open->push_back(adj);
+			}
+		}
+	}
+}
+
+
+void FanProgram::remove_faces(const std::vector<std::size_t>& faces, std::vector<char>* selected, std::vector<int>* count) const {
+	for (std::size_t i = 0; i < faces.size(); ++i) {
+		std::size_t f = faces[i];
+		if (!(*selected)[f])
+			continue;
+		(*selected)[f] = 0;
+		for (std::size_t j = 0; j < face_fans_[f].size(); ++j)
+			--(*count)[face_fans_[f][j]];
+	}
+}
+
+
+void FanProgram::repair(std::vector<char>* selected, const std::vector<double>& costs) const {
+	std::vector<int> count(fans_.size(), 0);
+	for (std::size_t k = 0; k < fans_.size(); ++k) {
+		for (std::size_t j = 0; j < fans_[k].size(); ++j)
+			count[k] += (*selected)[fans_[k][j]] ? 1 : 0;
+	}
+
+	// over-filled fans: unselect the most expensive faces
+	std::vector<std::size_t> removed;
+	for (std::size_t k = 0; k < fans_.size(); ++k) {
+		while (count[k] > 2) {
+			int worst = -1;
+			for (std::size_t j = 0; j < fans_[k].size(); ++j) {
+				std::size_t f = fans_[k][j];
+				if ((*selected)[f] && (worst == -1 || costs[f] > costs[worst]))
+					worst = static_cast<int>(f);
+			}
+			removed.assign(1, worst);
+			remove_faces(removed, selected, &count);
+		}
+	}
+
+	// open fans: close them with their cheapest faces, otherwise unselect their face.
+	// Unselected faces are banned, which guarantees termination.
+	std::vector<char> banned(face_fans_.size(), 0);
+	std::vector<std::size_t> open;
+	for (std::size_t k = 0; k < fans_.size(); ++k) {
+		if (count[k] == 1)
+			open.push_back(k);
+	}
+	for (std::size_t head = 0; head < open.size(); ++head) {
+		std::size_t k = open[head];
+		if (count[k] != 1)
+			continue;
+
+		int best = -1;
+		int current = -1;
+		for (std::size_t j = 0; j < fans_[k].size(); ++j) {
+			std::size_t f = fans_[k][j];
+			if ((*selected)[f]) {
+				current = static_cast<int>(f);
+				continue;
+			}
+			if (banned[f])
+				continue;
+
+			bool fits = true;
+			for (std::size_t l = 0; l < face_fans_[f].size(); ++l) {
+				if (count[face_fans_[f][l]] > 1) {
+					fits = false;
+					break;
+				}
+			}
+			if (fits && (best == -1 || costs[f] < costs[best]))
+				best = static_cast<int>(f);
+		}
+
+		int face = (best != -1) ? best : current;
+		(*selected)[face] = (best != -1) ? 1 : 0;
+		if (best == -1)
+			banned[face] = 1;
+		for (std::size_t l = 0; l < face_fans_[face].size(); ++l) {
+			std::size_t adj = face_fans_[face][l];
+			count[adj] += (best != -1) ? 1 : -1;
+			if (count[adj] == 1)
+				open.push_back(adj);
+		}
+	}
+}
+
+
+std::vector<char> FanProgram::greedy_selection() const {
+	return greedy_selection(costs_);
+}
+
+
+std::vector<char> FanProgram::greedy_selection(const std::vector<double>& ranking) const {
+	std::vector<char> selected(num_faces(), 0);
+	std::vector<int> count(num_fans(), 0);
+
+	// seeds: promising faces, best first
+	std::vector<std::size_t> seeds;
+	for (std::size_t f = 0; f < ranking.size(); ++f) {
+		if (ranking[f] < 0.0)
+			seeds.push_back(f);
+	}
+	std::sort(seeds.begin(), seeds.end(), [&ranking](std::size_t a, std::size_t b) { return ranking[a] < ranking[b]; });
+
+	std::vector<std::size_t> added;
+	for (std::size_t i = 0; i < seeds.size(); ++i) {
+		std::size_t seed = seeds[i];
+		if (selected[seed])
+			continue;
+
+		added.clear();
+		bool closed = close_patch(seed, ranking, &selected, &count, &added);
+
+		double delta = 0.0;
+		for (std::size_t j = 0; j < added.size(); ++j)
+			delta += costs_[added[j]];
+
+		// keep the patch only if it is closed and improves the objective
+		if (!closed || delta >= 0.0)
+			remove_faces(added, &selected, &count);
+	}
+
+	return selected;
+}
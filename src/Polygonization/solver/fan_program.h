@@ -0,0 +1,117 @@
+/*
+Copyright (C) 2017  Liangliang Nan
+https://3d.bk.tudelft.nl/liangliang/ - liangliang.nan@gmail.com
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+
+#ifndef _MATH_FAN_PROGRAM_H_
+#define _MATH_FAN_PROGRAM_H_
+
+#include "columnar_program.h"
+
+#include <vector>
+
+
+// A binary program in which every constraint reads
+//		x_f1 + x_f2 + ... + x_fk - 2 * y_e = 0,
+// i.e., the number of selected "faces" around an "edge" is either 0 or 2.
+// Each y_e appears in a single constraint. Variables that appear in no constraint are free.
+// This is the structure of the face selection problem of polygonal surface reconstruction,
+// which allows fast combinatorial heuristics.
+class FanProgram
+{
+public:
+	FanProgram() : sense_sign_(1.0), free_cost_(0.0) {}
+	~FanProgram() {}
+
+	// Recovers the fan structure from a program. Returns false if the program has a different structure.
+	bool extract(const ColumnarProgram* program);
+
+	std::size_t num_faces() const { return face_variables_.size(); }
+	std::size_t num_fans() const { return fans_.size(); }
+
+	// Cost of each face (always for minimization)
+	const std::vector<double>& costs() const { return costs_; }
+
+	// Faces of each fan, and fans of each face
+	const std::vector< std::vector<std::size_t> >& fans() const { return fans_; }
+	const std::vector< std::vector<std::size_t> >& face_fans() const { return face_fans_; }
+
+	// Returns true if every fan holds either 0 or 2 selected faces.
+	bool is_feasible(const std::vector<char>& selected) const;
+
+	// Objective value (in the sense of the program) of a selection.
+	double objective_value(const std::vector<char>& selected) const;
+
+	// Converts a selection to a solution of the program. Each entry corresponds to the
+	// variable with the same index in the program.
+	std::vector<double> to_solution(const std::vector<char>& selected) const;
+
+	// Value of a face in a solution of the program.
+	double face_value(const std::vector<double>& solution, std::size_t face) const { return solution[face_variables_[face]]; }
+
+	// Converts a solution of the program to a selection (values are rounded).
+	std::vector<char> to_selection(const std::vector<double>& solution) const;
+
+	// Greedy heuristic: seeds ranked by cost are grown into closed patches, which are kept
+	// only if they decrease the objective. The result is always feasible.
+	std::vector<char> greedy_selection() const;
+	// Same as above, but seeds and patches follow the given ranking of the faces (e.g., derived
+	// from a fractional solution). Patches are still kept only if they decrease the objective.
+	std::vector<char> greedy_selection(const std::vector<double>& ranking) const;
+
+	// Grows a patch from a seed, closing every open fan with its cheapest face.
+	// Starting from a feasible selection, returns false if the patch cannot be closed.
+	// The added faces are collected (they remain selected in any case).
+	bool close_patch(std::size_t seed, std::vector<char>* selected, std::vector<int>* count, std::vector<std::size_t>* added) const;
+	// Same as above, but ranks the faces with the given costs (e.g., perturbed costs).
+	bool close_patch(std::size_t seed, const std::vector<double>& costs, std::vector<char>* selected, std::vector<int>* count, std::vector<std::size_t>* added) const;
+
+	// Closes the open fans (i.e., holding a single selected face) with their cheapest faces,
+	// breadth first. The fans opened on the way are appended to "open".
+	bool close_fans(std::vector<std::size_t>* open, const std::vector<double>& costs, std::vector<char>* selected, std::vector<int>* count, std::vector<std::size_t>* added) const;
+
+	// Restores feasibility by unselecting every face of the open fans (propagated).
+	// The candidate fans to check are given in "open".
+	void drop_open_fans(std::vector<std::size_t>* open, std::vector<char>* selected, std::vector<int>* count, std::vector<std::size_t>* removed) const;
+
+	// Makes a selection feasible: over-filled fans keep their two cheapest faces, then open fans
+	// are closed with their cheapest faces, or lose their face if they cannot be closed.
+	// Faces are ranked with the given costs (e.g., derived from a fractional solution).
+	void repair(std::vector<char>* selected, const std::vector<double>& costs) const;
+
+	// Unselects the given faces and updates the fan counts.
+	void remove_faces(const std::vector<std::size_t>& faces, std::vector<char>* selected, std::vector<int>* count) const;
+
+private:
+	void clear();
+
+private:
+	std::size_t num_variables_;
+	double		sense_sign_;	// -1 for maximization
+	double		free_cost_;		// best cost of the free variables
+
+	std::vector<std::size_t>				face_variables_;	// program variable of each face
+	std::vector<std::size_t>				edge_variables_;	// program variable of each fan
+	std::vector<std::size_t>				free_variables_;	// program variables in no constraint
+	std::vector<double>						free_costs_;
+	std::vector<double>						costs_;
+	std::vector< std::vector<std::size_t> >	fans_;
+	std::vector< std::vector<std::size_t> >	face_fans_;
+};
+
+#endif
@@ -227,6 +227,7 @@ double LinearExpression::solution_value(bool rounded /* = false*/) const {
 LinearConstraint::LinearConstraint(LinearProgram* program, LinearConstraint::BoundType bt, double lb, double ub) 
 	: LinearExpression(program)
 	, Bound(bt, lb, ub) 
+	, lazy_(false)
 {
 }
 
@@ -269,6 +270,8 @@ void LinearProgram::clear() {
 		delete constraints_[i];
 	constraints_.clear();
 
+	mip_start_.clear();
+
 	objective_->clear();
 }
 
@@ -390,6 +393,16 @@ std::size_t LinearProgram::num_binary_variables() const {
 }
 
 
+std::size_t LinearProgram::num_lazy_constraints() const {
+	std::size_t num_lazy = 0;
+	for (std::size_t i = 0; i < constraints_.size(); ++i) {
+		if (constraints_[i]->is_lazy())
+			++num_lazy;
+	}
+	return num_lazy;
+}
+
+
 // returns true if all variables are continuous
 bool LinearProgram::is_continuous() const {
 	std::size_t num = num_continuous_variables();
@@ -143,6 +143,14 @@ public:
 	// A constraint cannot belong to several models.
 	// "program" is the program the owns this constraint.
 	LinearConstraint(LinearProgram* program, LinearConstraint::BoundType bt, double lb, double ub);
+
+	// A lazy constraint is expected to be satisfied by most solutions. Solvers only enforce it
+	// once it is violated (natively, or by adding it and solving again).
+	void set_lazy(bool lazy) { lazy_ = lazy; }
+	bool is_lazy() const { return lazy_; }
+
+private:
+	bool lazy_;
 };
 
 
@@ -218,6 +226,11 @@ public:
 	const LinearObjective* objective() const;
 	LinearObjective* objective();
 
+	// Provide a (feasible) solution to start from. Each entry corresponds to the variable
+	// with the same index. Solvers supporting MIP starts will use it as the initial incumbent.
+	void set_mip_start(const std::vector<double>& values) { mip_start_ = values; }
+	const std::vector<double>& mip_start() const { return mip_start_; }
+
 	//////////////////////////////////////////////////////////////////////////
 
 	std::size_t num_continuous_variables() const;
@@ -228,6 +241,8 @@ public:
 	bool is_mix_integer_program() const;	// returns true if mixed inter program
 	bool is_integer_program() const;		// returns true if inter program
 	bool is_binary_proram() const;			// returns true if binary program
+
+	std::size_t num_lazy_constraints() const;
 	
 	//////////////////////////////////////////////////////////////////////////
 
@@ -240,6 +255,8 @@ private:
 
 	std::vector<Variable*>			variables_;
 	std::vector<LinearConstraint*>	constraints_;
+
+	std::vector<double>				mip_start_;
 };
 
 
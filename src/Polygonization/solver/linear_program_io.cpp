@@ -0,0 +1,328 @@
+/*
+Copyright (C) 2017  Liangliang Nan
+https://3d.bk.tudelft.nl/liangliang/ - liangliang.nan@gmail.com
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+
+#include "linear_program_io.h"
+#include "columnar_program.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <unordered_map>
+#include <cstdlib>
+#include <cmath>
+
+
+namespace {
+
+	bool is_infinite(double value) { return std::abs(value) >= Variable::infinity(); }
+
+
+	std::vector<std::string> variable_names(const LinearProgram* program) {
+		std::vector<std::string> names;
+		const std::vector<Variable*>& variables = program->variables();
+		for (std::size_t i = 0; i < variables.size(); ++i)
+			names.push_back(variables[i]->name());
+		return names;
+	}
+
+
+	// Constraint names, ranged constraints get a "_lo" and an "_up" row in LP format
+	std::vector<std::string> constraint_names(const LinearProgram* program) {
+		std::vector<std::string> names;
+		const std::vector<LinearConstraint*>& constraints = program->constraints();
+		for (std::size_t i = 0; i < constraints.size(); ++i)
+			names.push_back(constraints[i]->name().empty() ? "c" + std::to_string(i) : constraints[i]->name());
+		return names;
+	}
+
+
+	// Writes a linear expression, wrapping long lines
+	void write_expression(std::ostream& out, const int* columns, const double* values, std::size_t size, const std::vector<std::string>& names) {
+		if (size == 0) {
+			out << " 0 " << names[0];
+			return;
+		}
+		for (std::size_t k = 0; k < size; ++k) {
+			out << (values[k] < 0.0 ? " - " : " + ") << std::abs(values[k]) << " " << names[columns[k]];
+			if (k % 8 == 7 && k + 1 < size)
+				out << "\n  ";
+		}
+	}
+
+}
+
+
+bool write_mps(const LinearProgram* program, const std::string& file_name) {
+	std::ofstream out(file_name.c_str());
+	if (!out) {
+		std::cerr << "could not open file \'" << file_name << "\'" << std::endl;
+		return false;
+	}
+	out << std::setprecision(17);
+
+	ColumnarProgram columnar;
+	columnar.assign(program);
+	std::vector<std::string> names = variable_names(program);
+	std::vector<std::string> rows = constraint_names(program);
+	std::size_t num_variables = columnar.num_variables();
+	std::size_t num_constraints = columnar.num_constraints();
+
+	// Rows
+	out << "NAME " << (program->name().empty() ? "program" : program->name()) << "\n";
+	if (columnar.sense() == LinearObjective::MAXIMIZE)
+		out << "OBJSENSE\n    MAX\n";
+	out << "ROWS\n N  obj\n";
+	const std::vector<double>& row_lower = columnar.row_lower_bounds();
+	const std::vector<double>& row_upper = columnar.row_upper_bounds();
+	for (std::size_t i = 0; i < num_constraints; ++i) {
+		char type = 'N';
+		if (!is_infinite(row_lower[i]) && !is_infinite(row_upper[i]))
+			type = (row_lower[i] == row_upper[i]) ? 'E' : 'G';	// ranged rows are G rows with a range
+		else if (!is_infinite(row_lower[i]))
+			type = 'G';
+		else if (!is_infinite(row_upper[i]))
+			type = 'L';
+		out << " " << type << "  " << rows[i] << "\n";
+	}
+
+	// Columns: the CSR matrix is transposed
+	const std::vector<int>& row_start = columnar.row_start();
+	std::vector< std::vector< std::pair<std::size_t, double> > > columns(num_variables);
+	for (std::size_t i = 0; i < num_constraints; ++i) {
+		for (int k = row_start[i]; k < row_start[i + 1]; ++k)
+			columns[columnar.columns()[k]].push_back(std::make_pair(i, columnar.values()[k]));
+	}
+
+	out << "COLUMNS\n";
+	const std::vector<char>& types = columnar.types();
+	bool integer_section = false;
+	for (std::size_t j = 0; j < num_variables; ++j) {
+		bool is_integer = (types[j] != ColumnarProgram::CONTINUOUS);
+		if (is_integer != integer_section) {
+			out << "    MARKER  'MARKER'  " << (is_integer ? "'INTORG'" : "'INTEND'") << "\n";
+			integer_section = is_integer;
+		}
+		if (columnar.objective()[j] != 0.0 || columns[j].empty())
+			out << "    " << names[j] << "  obj  " << columnar.objective()[j] << "\n";
+		for (std::size_t k = 0; k < columns[j].size(); ++k)
+			out << "    " << names[j] << "  " << rows[columns[j][k].first] << "  " << columns[j][k].second << "\n";
+	}
+	if (integer_section)
+		out << "    MARKER  'MARKER'  'INTEND'\n";
+
+	// Right-hand sides and ranges
+	out << "RHS\n";
+	for (std::size_t i = 0; i < num_constraints; ++i) {
+		double rhs = !is_infinite(row_lower[i]) ? row_lower[i] : row_upper[i];
+		if (!is_infinite(rhs) && rhs != 0.0)
+			out << "    rhs  " << rows[i] << "  " << rhs << "\n";
+	}
+	out << "RANGES\n";
+	for (std::size_t i = 0; i < num_constraints; ++i) {
+		if (!is_infinite(row_lower[i]) && !is_infinite(row_upper[i]) && row_lower[i] != row_upper[i])
+			out << "    rng  " << rows[i] << "  " << row_upper[i] - row_lower[i] << "\n";
+	}
+
+	// Bounds: explicit for all the variables, the defaults differ between solvers
+	out << "BOUNDS\n";
+	const std::vector<double>& lower = columnar.lower_bounds();
+	const std::vector<double>& upper = columnar.upper_bounds();
+	for (std::size_t j = 0; j < num_variables; ++j) {
+		if (types[j] == ColumnarProgram::BINARY)
+			out << " BV bnd  " << names[j] << "\n";
+		else if (is_infinite(lower[j]) && is_infinite(upper[j]))
+			out << " FR bnd  " << names[j] << "\n";
+		else if (lower[j] == upper[j])
+			out << " FX bnd  " << names[j] << "  " << lower[j] << "\n";
+		else {
+			if (is_infinite(lower[j]))
+				out << " MI bnd  " << names[j] << "\n";
+			else
+				out << " LO bnd  " << names[j] << "  " << lower[j] << "\n";
+			if (is_infinite(upper[j]))
+				out << " PL bnd  " << names[j] << "\n";
+			else
+				out << " UP bnd  " << names[j] << "  " << upper[j] << "\n";
+		}
+	}
+	out << "ENDATA\n";
+
+	return out.good();
+}
+
+
+bool write_lp(const LinearProgram* program, const std::string& file_name) {
+	std::ofstream out(file_name.c_str());
+	if (!out) {
+		std::cerr << "could not open file \'" << file_name << "\'" << std::endl;
+		return false;
+	}
+	out << std::setprecision(17);
+
+	ColumnarProgram columnar;
+	columnar.assign(program);
+	std::vector<std::string> names = variable_names(program);
+	std::vector<std::string> rows = constraint_names(program);
+	std::size_t num_variables = columnar.num_variables();
+	std::size_t num_constraints = columnar.num_constraints();
+
+	// Objective
+	out << "\\ " << (program->name().empty() ? "program" : program->name()) << "\n";
+	out << (columnar.sense() == LinearObjective::MAXIMIZE ? "Maximize" : "Minimize") << "\n obj:";
+	std::vector<int> objective_columns;
+	std::vector<double> objective_values;
+	for (std::size_t j = 0; j < num_variables; ++j) {
+		if (columnar.objective()[j] != 0.0) {
+			objective_columns.push_back(static_cast<int>(j));
+			objective_values.push_back(columnar.objective()[j]);
+		}
+	}
+	write_expression(out, objective_columns.data(), objective_values.data(), objective_columns.size(), names);
+	out << "\n";
+
+	// Constraints
+	out << "Subject To\n";
+	const std::vector<int>& row_start = columnar.row_start();
+	const std::vector<double>& row_lower = columnar.row_lower_bounds();
+	const std::vector<double>& row_upper = columnar.row_upper_bounds();
+	for (std::size_t i = 0; i < num_constraints; ++i) {
+		const int* columns = columnar.columns().data() + row_start[i];
+		const double* values = columnar.values().data() + row_start[i];
+		std::size_t size = row_start[i + 1] - row_start[i];
+		bool has_lower = !is_infinite(row_lower[i]);
+		bool has_upper = !is_infinite(row_upper[i]);
+
+		if (has_lower && has_upper && row_lower[i] == row_upper[i]) {
+			out << " " << rows[i] << ":";
+			write_expression(out, columns, values, size, names);
+			out << " = " << row_lower[i] << "\n";
+			continue;
+		}
+		if (has_lower) {
+			out << " " << rows[i] << (has_upper ? "_lo:" : ":");
+			write_expression(out, columns, values, size, names);
+			out << " >= " << row_lower[i] << "\n";
+		}
+		if (has_upper) {
+			out << " " << rows[i] << (has_lower ? "_up:" : ":");
+			write_expression(out, columns, values, size, names);
+			out << " <= " << row_upper[i] << "\n";
+		}
+	}
+
+	// Bounds
+	out << "Bounds\n";
+	const std::vector<char>& types = columnar.types();
+	const std::vector<double>& lower = columnar.lower_bounds();
+	const std::vector<double>& upper = columnar.upper_bounds();
+	for (std::size_t j = 0; j < num_variables; ++j) {
+		if (types[j] == ColumnarProgram::BINARY)
+			continue;
+		if (is_infinite(lower[j]) && is_infinite(upper[j]))
+			out << " " << names[j] << " free\n";
+		else if (lower[j] == upper[j])
+			out << " " << names[j] << " = " << lower[j] << "\n";
+		else {
+			out << " ";
+			if (is_infinite(lower[j]))
+				out << "-inf";
+			else
+				out << lower[j];
+			out << " <= " << names[j] << " <= ";
+			if (is_infinite(upper[j]))
+				out << "+inf\n";
+			else
+				out << upper[j] << "\n";
+		}
+	}
+
+	// Integrality
+	const char sections[2] = { ColumnarProgram::BINARY, ColumnarProgram::INTEGER };
+	const char* headers[2] = { "Binaries", "Generals" };
+	for (std::size_t s = 0; s < 2; ++s) {
+		std::size_t count = 0;
+		for (std::size_t j = 0; j < num_variables; ++j) {
+			if (types[j] != sections[s])
+				continue;
+			out << (count == 0 ? std::string(headers[s]) + "\n" : std::string()) << " " << names[j];
+			if (++count % 8 == 0)
+				out << "\n";
+		}
+		if (count % 8 != 0)
+			out << "\n";
+	}
+	out << "End\n";
+
+	return out.good();
+}
+
+
+bool read_solution(const std::string& file_name, const std::vector<std::string>& names, std::vector<double>* values) {
+	std::ifstream in(file_name.c_str());
+	if (!in) {
+		std::cerr << "could not open file \'" << file_name << "\'" << std::endl;
+		return false;
+	}
+
+	std::unordered_map<std::string, std::size_t> indices;
+	for (std::size_t i = 0; i < names.size(); ++i)
+		indices[names[i]] = i;
+
+	// Lines "name value" (Gurobi, HiGHS, SCIP: followed by "(obj:...)")
+	// or "index name value ..." (CBC). Anything else is skipped.
+	values->assign(names.size(), 0.0);
+	std::size_t num_found = 0;
+	std::string line;
+	while (std::getline(in, line)) {
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		std::istringstream tokens(line);
+		std::string first, second, third;
+		tokens >> first >> second >> third;
+		auto pos = indices.find(first);
+		std::string value = second;
+		if (pos == indices.end()) {
+			pos = indices.find(second);
+			value = third;
+		}
+		if (pos == indices.end() || value.empty())
+			continue;
+
+		char* end = 0;
+		double x = std::strtod(value.c_str(), &end);
+		if (end == value.c_str())
+			continue;
+		(*values)[pos->second] = x;
+		++num_found;
+	}
+
+	if (num_found == 0) {
+		std::cerr << "no variable of the program was found in file \'" << file_name << "\'" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+
+bool read_solution(const std::string& file_name, const LinearProgram* program, std::vector<double>* values) {
+	return read_solution(file_name, variable_names(program), values);
+}
@@ -0,0 +1,45 @@
+/*
+Copyright (C) 2017  Liangliang Nan
+https://3d.bk.tudelft.nl/liangliang/ - liangliang.nan@gmail.com
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+
+#ifndef _MATH_LINEAR_PROGRAM_IO_H_
+#define _MATH_LINEAR_PROGRAM_IO_H_
+
+#include "linear_program.h"
+
+#include <string>
+#include <vector>
+
+
+// Writes the program in free MPS format, to be solved offline by any MIP solver.
+// NOTE: lazy constraints are written as ordinary constraints (the model is the same).
+bool write_mps(const LinearProgram* program, const std::string& file_name);
+
+// Writes the program in CPLEX LP format. Ranged constraints are split into two rows.
+bool write_lp(const LinearProgram* program, const std::string& file_name);
+
+// Reads a solution file written by a solver (Gurobi, SCIP, CBC, HiGHS...): each line holding
+// the name of a variable followed by its value. Comment lines start with '#'. Variables not
+// listed are 0. values receives one entry per name, returns false if no variable was found.
+bool read_solution(const std::string& file_name, const std::vector<std::string>& names, std::vector<double>* values);
+
+// Same as above, for the variables of a program.
+bool read_solution(const std::string& file_name, const LinearProgram* program, std::vector<double>* values);
+
+#endif
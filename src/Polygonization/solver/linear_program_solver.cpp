@@ -21,48 +21,162 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "linear_program_solver.h"
 
 #include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
 #include <cmath>
 
 
-bool LinearProgramSolver::check_program(const LinearProgram* program) const {
-	if (program->objective()->sense() == LinearObjective::UNDEFINED) {
+bool LinearProgramSolver::check_program(const ColumnarProgram* program) const {
+	if (program->sense() == LinearObjective::UNDEFINED) {
 		std::cerr << "incomplete objective: undefined objective sense." << std::endl;
 		return false;
 	}
 
-	const std::vector<Variable*>& variables = program->variables();
-	if (variables.empty()) {
+	if (program->num_variables() == 0) {
 		std::cerr << "variable set is empty" << std::endl;
 		return false;
 	}
 
-	// TODO: check if multiple variables have the same name or index
+	return true;
+}
 
-	// TODO: check if multiple constraints have the same name or index
 
-	return true;
+void LinearProgramSolver::round_solution(const ColumnarProgram* program) {
+	const std::vector<char>& types = program->types();
+	for (std::size_t i = 0; i < result_.size(); ++i) {
+		if (types[i] != ColumnarProgram::CONTINUOUS)
+			result_[i] = static_cast<int>(std::round(result_[i]));
+	}
 }
 
 
 void LinearProgramSolver::upload_solution(const LinearProgram* program) {
 	std::vector<Variable*>& variables = const_cast<LinearProgram*>(program)->variables();
-	for (std::size_t i = 0; i < variables.size(); ++i) {
-		Variable* v = variables[i];
-		v->set_solution_value(result_[i]);
-		if (v->variable_type() != Variable::CONTINUOUS)
-			result_[i] = static_cast<int>(std::round(result_[i]));
-	}
+	for (std::size_t i = 0; i < variables.size(); ++i)
+		variables[i]->set_solution_value(result_[i]);
 }
 
 
 bool LinearProgramSolver::solve(const LinearProgram* program, SolverName solver) {
-    if (solver == GUROBI)
+	ColumnarProgram columnar;
+	columnar.assign(program);
+
+	if (!solve(&columnar, solver))
+		return false;
+
+	upload_solution(program);
+	return true;
+}
+
+
+bool LinearProgramSolver::solve(const ColumnarProgram* program, SolverName solver) {
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point t0 = Clock::now();
+
+	status_ = FAILED;
+	result_.clear();
+	gap_ = -1.0;
+
+	report_ = SolveReport();
+	report_.solver = solver;
+	report_.num_variables = static_cast<long>(program->num_variables());
+	report_.num_constraints = static_cast<long>(program->num_constraints());
+	report_.num_nonzeros = static_cast<long>(program->num_nonzeros());
+
+	bool success = false;
+	if (cache_ && cache_->lookup(program, &result_, &objective_value_)) {
+		status_ = OPTIMAL;
+		gap_ = 0.0;
+		report_.cache_hit = true;
+		success = true;
+	}
+	else {
+		success = _solve(program, solver);
+		if (success && cache_ && status_ == OPTIMAL)
+			cache_->store(program, result_, objective_value_);
+	}
+
+	report_.solve_time = std::chrono::duration<double>(Clock::now() - t0).count();
+	report_.status = status_;
+	report_.gap = gap_;
+	if (success)
+		report_.objective_value = objective_value_;
+	return success;
+}
+
+
+bool LinearProgramSolver::_solve(const ColumnarProgram* program, SolverName solver) {
+	if (solver == GUROBI) {
 #ifdef HAS_GUROBI
-        return _solve_GUROBI(program);
+		return _solve_GUROBI(program);
+#else
+		return _solve_fallback(program, "Gurobi requested but not available on this machine");
+#endif
+	}
+	else if (solver == SOPLEX) {
+#ifdef HAS_SOPLEX
+		return _solve_SOPLEX(program);
 #else
-        std::cerr << "WARNING: Gurobi requested but not available on this machine. The SCIP solver will be used instead" << std::endl;
+		return _solve_fallback(program, "SoPlex requested but not built with this program");
 #endif
-        std::cerr << "\033[1;31mError: PSYCH — SCIP just doesn't work anymore, nerd.\033[0m" << std::endl;
-    // return _solve_SCIP(program);
+	}
+	else if (solver == HIGHS) {
+#ifdef HAS_HIGHS
+		return _solve_HIGHS(program);
+#else
+		return _solve_fallback(program, "HiGHS requested but not built with this program");
+#endif
+	}
+	else if (solver == PORTFOLIO)
+		return _solve_PORTFOLIO(program);
+	else if (solver == SCIP)
+		return _solve_fallback(program, "SCIP is not built with this program");
+
+	return _solve_LOCAL_SEARCH(program);
 }
 
+
+bool LinearProgramSolver::_solve_fallback(const ColumnarProgram* program, const char* reason) {
+	std::cerr << "WARNING: " << reason << ". The local search solver will be used instead" << std::endl;
+	report_.solver = LOCAL_SEARCH;
+	bool success = _solve_LOCAL_SEARCH(program);
+	if (success && status_ != OPTIMAL)
+		std::cerr << "WARNING: the local search solution is feasible but not proven optimal" << std::endl;
+	return success;
+}
+
+
+namespace {
+
+	// Infinite bounds (no incumbent yet, or no bound) are written as null
+	std::string json_number(double value) {
+		if (!std::isfinite(value) || std::abs(value) >= 1e30)
+			return "null";
+		std::ostringstream out;
+		out << std::setprecision(10) << value;
+		return out.str();
+	}
+
+}
+
+
+std::string LinearProgramSolver::SolveReport::to_json() const {
+	static const char* solver_names[] = { "gurobi", "scip", "local_search", "soplex", "portfolio", "highs" };
+	static const char* status_names[] = { "optimal", "feasible", "infeasible", "no_solution", "failed" };
+
+	std::ostringstream out;
+	out << std::setprecision(10);
+	out << "{\"solver\": \"" << solver_names[solver] << "\", \"cache_hit\": " << (cache_hit ? "true" : "false")
+		<< ", \"variables\": " << num_variables << ", \"constraints\": " << num_constraints << ", \"nonzeros\": " << num_nonzeros
+		<< ", \"presolved_variables\": " << presolved_variables << ", \"presolved_constraints\": " << presolved_constraints
+		<< ", \"presolve_time\": " << presolve_time << ", \"solve_time\": " << solve_time
+		<< ", \"root_bound\": " << (has_root_bound ? json_number(root_bound) : "null")
+		<< ", \"nodes\": " << node_count << ", \"status\": \"" << status_names[status] << "\""
+		<< ", \"objective\": " << json_number(objective_value) << ", \"gap\": " << gap << ", \"progress\": [";
+	for (std::size_t i = 0; i < progress.size(); ++i) {
+		out << (i > 0 ? ", " : "") << "[" << progress[i].time << ", " << json_number(progress[i].primal) << ", " << json_number(progress[i].dual) << "]";
+	}
+	out << "]}";
+	return out.str();
+}
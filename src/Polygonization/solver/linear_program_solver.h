@@ -21,29 +21,132 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #define _MATH_LINEAR_PROGRAM_SOLVER_H_
 
 #include "linear_program.h"
+#include "columnar_program.h"
+#include "solution_cache.h"
 
 #include <vector>
+#include <string>
+#include <atomic>
 
 
 class LinearProgramSolver
 {
 public:
 	enum SolverName {
-		GUROBI, // Gurobi is commercial and requires license :-(
-		SCIP	// Recommended default value.
+		GUROBI,			// Gurobi is commercial and requires license :-(
+		SCIP,			// Not built with this program, the local search is used instead.
+		LOCAL_SEARCH,	// Built-in heuristic for face selection programs (no external library).
+		SOPLEX,			// LP relaxation with rounding, fast when the relaxation is almost integral.
+		PORTFOLIO,		// Several backends run concurrently, the first optimal (or the best) result is kept.
+		HIGHS			// Open source MIP solver, optional (built when HiGHS is found).
+	};
+
+	// Outcome of a solve
+	enum Status {
+		OPTIMAL,		// optimal within the relative gap
+		FEASIBLE,		// budget exhausted (or heuristic solver), the best incumbent is returned
+		INFEASIBLE,		// infeasible or unbounded
+		NO_SOLUTION,	// budget exhausted before any solution was found
+		FAILED			// error or unsupported program
+	};
+
+	// Resources granted to a solve. Negative values mean no limit (or the solver default).
+	struct Budget {
+		double	time_limit = -1.0;		// wall-clock time, in seconds
+		long	node_limit = -1;		// branch-and-bound nodes
+		double	relative_gap = 1e-4;	// stop when |incumbent - bound| / |incumbent| is below
+		int		num_threads = 0;		// 0 for all cores
+	};
+
+	// Search emphasis (Gurobi only, ignored by the other backends)
+	enum Emphasis {
+		BALANCED,		// solver defaults
+		FEASIBILITY,	// good incumbents early (heuristics)
+		OPTIMALITY		// proving optimality (aggressive presolve and cuts)
+	};
+
+	// A member of the portfolio: a backend and its parameter set
+	struct PortfolioEntry {
+		SolverName	solver;
+		Emphasis	emphasis;
+	};
+
+	// Telemetry of a solve. Negative values mean unknown (not reported by the backend).
+	// Gurobi fills in all the fields (from its callback), the other backends
+	// report the model size, the status, the times and the final bounds.
+	struct SolveReport {
+		// Primal (incumbent) and dual (bound) objective values at a point in time
+		struct Sample {
+			double	time;
+			double	primal;
+			double	dual;
+		};
+
+		SolverName	solver = LOCAL_SEARCH;
+		bool		cache_hit = false;
+
+		// Model size before and after the presolve of the solver
+		long	num_variables = -1;
+		long	num_constraints = -1;
+		long	num_nonzeros = -1;
+		long	presolved_variables = -1;
+		long	presolved_constraints = -1;
+
+		double	presolve_time = -1.0;		// seconds
+		double	solve_time = -1.0;			// seconds, presolve included
+		double	root_bound = -1.0;			// objective of the root LP relaxation (valid if has_root_bound)
+		bool	has_root_bound = false;
+		long	node_count = -1;
+
+		// Gap over time, sampled by the callbacks (at most every 0.1 seconds, and at each new incumbent)
+		std::vector<Sample> progress;
+
+		Status	status = FAILED;
+		double	objective_value = 0.0;
+		double	gap = -1.0;
+
+		// Single line JSON object
+		std::string to_json() const;
 	};
 
 public:
-	LinearProgramSolver() {}
+	LinearProgramSolver() : emphasis_(BALANCED), cancel_(0), cache_(0), verbose_(true), status_(FAILED), objective_value_(0.0), relaxation_bound_(0.0), gap_(-1.0) {}
 	~LinearProgramSolver() {}
 
-	// Solves the problem and returns false if fails.
+	void set_budget(const Budget& budget) { budget_ = budget; }
+	const Budget& budget() const { return budget_; }
+
+	void set_emphasis(Emphasis emphasis) { emphasis_ = emphasis; }
+
+	// Members run by the PORTFOLIO solver (empty for default_portfolio()).
+	// The budget is shared: all the members stop at the time limit and split the threads.
+	// Without a time limit, the members that cannot be cancelled are left out (the portfolio
+	// would wait for them even after another member proved optimality).
+	void set_portfolio(const std::vector<PortfolioEntry>& entries) { portfolio_ = entries; }
+	static std::vector<PortfolioEntry> default_portfolio();
+
+	// The solve stops as soon as the flag is set and returns its best incumbent (if any).
+	// Only the backends for which is_cancellable() holds poll the flag.
+	void set_cancel_flag(const std::atomic<bool>* flag) { cancel_ = flag; }
+	static bool is_cancellable(SolverName solver);
+
+	// Optimal solutions are looked up in (and added to) the cache, a hit skips the solve.
+	void set_cache(SolutionCache* cache) { cache_ = cache; }
+
+	// Print which backend is used and its summary (warnings and errors are always printed).
+	void set_verbose(bool verbose) { verbose_ = verbose; }
+
+	// Solves the problem and returns false if no solution is available.
+	// When the budget runs out, the best incumbent is returned (status() is FEASIBLE).
 	// NOTE: The SCIP solver is slower than Gurobi but acceptable.
 	//       If you have a really LARGE problem, you may consider using Gurobi.
     bool solve(const LinearProgram* program, SolverName solver);
 
+	// Same as above, for a program stored in arrays (faster to build and to pass to the solvers).
+	bool solve(const ColumnarProgram* program, SolverName solver);
+
 	// Returns the result. 
-	// The result can also be retrieved using Variable::solution_value().
+	// For a LinearProgram, the result can also be retrieved using Variable::solution_value().
 	// NOTE: (1) result is valid only if the solver succeeded.
 	//       (2) each entry in the result corresponds to the variable with the
 	//			 same index in the linear program.
@@ -54,19 +157,54 @@ public:
 	//       (2) the constant term is not included.
 	double objective_value() const { return objective_value_; }
 
+	// Returns the status of the last solve.
+	Status status() const { return status_; }
+
+	// Returns the telemetry of the last solve.
+	const SolveReport& report() const { return report_; }
+
+	// Returns the relative gap of the solution (negative if unknown, e.g., for the local search).
+	double gap() const { return gap_; }
+
+	// Returns the objective value of the LP relaxation (SoPlex solver only).
+	// The integrality gap is |objective_value() - relaxation_bound()| / |objective_value()|.
+	double relaxation_bound() const { return relaxation_bound_; }
+
 private:
-	bool check_program(const LinearProgram* program) const;
+	bool _solve(const ColumnarProgram* program, SolverName solver);
+	bool _solve_fallback(const ColumnarProgram* program, const char* reason);	// runs the local search instead
+	bool check_program(const ColumnarProgram* program) const;
+	void round_solution(const ColumnarProgram* program);
 	void upload_solution(const LinearProgram* program);
 
 private:
 #ifdef HAS_GUROBI
-	bool _solve_GUROBI(const LinearProgram* program);
+	bool _solve_GUROBI(const ColumnarProgram* program);
+#endif
+	bool _solve_LOCAL_SEARCH(const ColumnarProgram* program);
+	bool _solve_PORTFOLIO(const ColumnarProgram* program);
+#ifdef HAS_HIGHS
+	bool _solve_HIGHS(const ColumnarProgram* program);
+#endif
+#ifdef HAS_SOPLEX
+	bool _solve_SOPLEX(const ColumnarProgram* program);
 #endif
-	bool _solve_SCIP(const LinearProgram* program);
 
 private:
+	Budget				budget_;
+	Emphasis			emphasis_;
+	std::vector<PortfolioEntry> portfolio_;
+	const std::atomic<bool>* cancel_;
+	SolutionCache*		cache_;
+	bool				verbose_;
+
+	Status				status_;
 	std::vector<double> result_;
 	double				objective_value_;
+	double				relaxation_bound_;
+	double				gap_;
+
+	SolveReport			report_;
 };
 
 #endif
@@ -23,138 +23,243 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #ifdef HAS_GUROBI
 
-#include <gurobi_c++.h>
+#include <gurobi_c.h>
+
+#include <iostream>
+#include <algorithm>
 
 #ifdef WIN32
 #if (_MSC_VER == 1900) // vs 2015
 #pragma comment(lib, "gurobi80.lib")
-#ifdef _DEBUG
-#pragma comment(lib, "gurobi_c++mdd2015.lib")
-#else
-#pragma comment(lib, "gurobi_c++md2015.lib")
-#endif
 #elif (_MSC_VER >= 1910 && _MSC_VER <= 1915) // vs 2017
 #pragma comment(lib, "gurobi81.lib")
-#ifdef _DEBUG
-#pragma comment(lib, "gurobi_c++mdd2017.lib")
-#else
-#pragma comment(lib, "gurobi_c++md2017.lib")
-#endif
 #endif
 #endif
 
 
-bool LinearProgramSolver::_solve_GUROBI(const LinearProgram* program) {
-	try {
-		if (!check_program(program))
-			return false;
+namespace {
+
+	// I am using an academic license of Gurobi. Each time when a Gurobi environment is created, it pops up a
+	// notice "Academic license - for non-commercial use only".
+	// It is not possible to suppress this notice completely, but we can get the Gurobi environment only once and
+	// reuse it later on. Gurobi environments must not be shared between threads, so each thread keeps its own.
+	struct Environment {
+		Environment() : env(0) {
+			if (GRBloadenv(&env, 0) == 0)
+				GRBsetintparam(env, GRB_INT_PAR_LOGTOCONSOLE, 0);
+			else {
+				std::cerr << GRBgeterrormsg(env) << std::endl;
+				GRBfreeenv(env);
+				env = 0;
+			}
+		}
+		~Environment() { if (env) GRBfreeenv(env); }
 
-		// I am using an academic license of Gurobi. Each time when a Gurobi environment is created, it pops up a
-		// notice "Academic license - for non-commercial use only".
-		// It is not possible to suppress this notice completely, but we can get the Gurobi environment only once and
-		// reuse it later on.
-		static GRBEnv env = GRBEnv();
-		env.set(GRB_IntParam_LogToConsole, 0);
+		GRBenv* env;
+	};
 
-		GRBModel model = GRBModel(env);
 
-		// create variables
-		const std::vector<Variable*>& variables = program->variables();
-		std::vector<GRBVar> X(variables.size());
-		for (std::size_t i = 0; i < variables.size(); ++i) {
-			const Variable* var = variables[i];
+	// State shared with the callback
+	struct CallbackData {
+		const std::atomic<bool>*		 cancel;
+		LinearProgramSolver::SolveReport* report;
+		double							 last_sample;
+		double							 last_primal;
+	};
 
-			double lb, ub;
-			var->get_bounds(lb, ub);
 
-			char vtype = GRB_CONTINUOUS;
-			if (var->variable_type() == Variable::INTEGER)
-				vtype = GRB_INTEGER;
-			else if (var->variable_type() == Variable::BINARY)
-				vtype = GRB_BINARY;
+	// Fills in the report (presolve, root bound, gap over time) and stops the optimization
+	// when the cancel flag is set (e.g., another member of a portfolio proved optimality)
+	int __stdcall callback(GRBmodel* model, void* cbdata, int where, void* usrdata) {
+		CallbackData* data = static_cast<CallbackData*>(usrdata);
+		if (data->cancel && data->cancel->load())
+			GRBterminate(model);
 
-			X[i] = model.addVar(lb, ub, 0.0, vtype);
-		}
+		LinearProgramSolver::SolveReport* report = data->report;
+		double runtime = 0.0;
+		GRBcbget(cbdata, where, GRB_CB_RUNTIME, &runtime);
 
-		// Integrate new variables
-		model.update();
-
-		// Add constraints
-		const std::vector<LinearConstraint*>& constraints = program->constraints();
-		for (std::size_t i = 0; i < constraints.size(); ++i) {
-			GRBLinExpr expr;
-			const LinearConstraint* c = constraints[i];
-			const std::unordered_map<int, double>& coeffs = c->coefficients();
-			std::unordered_map<int, double>::const_iterator cur = coeffs.begin();
-			for (; cur != coeffs.end(); ++cur) {
-                std::size_t var_idx = static_cast<std::size_t>(cur->first);
-				double coeff = cur->second;
-				expr += coeff * X[var_idx];
+		if (where == GRB_CB_PRESOLVE) {
+			int removed_columns = 0, removed_rows = 0;
+			if (GRBcbget(cbdata, where, GRB_CB_PRE_COLDEL, &removed_columns) == 0 &&
+				GRBcbget(cbdata, where, GRB_CB_PRE_ROWDEL, &removed_rows) == 0) {
+				report->presolved_variables = report->num_variables - removed_columns;
+				report->presolved_constraints = report->num_constraints - removed_rows;
 			}
-
-			switch (c->bound_type())
-			{
-			case LinearConstraint::FIXED:
-				model.addConstr(expr == c->get_bound());
-				break;
-			case LinearConstraint::LOWER:
-				model.addConstr(expr >= c->get_bound());
-				break;
-			case LinearConstraint::UPPER:
-				model.addConstr(expr <= c->get_bound());
-				break;
-			case LinearConstraint::DOUBLE: {
-				double lb, ub;
-				c->get_bounds(lb, ub);
-				model.addConstr(expr >= lb);
-				model.addConstr(expr <= ub);
-				break;
-				}
-			default:
-				break;
+			report->presolve_time = runtime;
+		}
+		else if (where == GRB_CB_MIPNODE) {
+			// the first node solved is the root
+			int node_status = 0;
+			double node_count = 0.0;
+			if (!report->has_root_bound &&
+				GRBcbget(cbdata, where, GRB_CB_MIPNODE_STATUS, &node_status) == 0 && node_status == GRB_OPTIMAL &&
+				GRBcbget(cbdata, where, GRB_CB_MIPNODE_NODCNT, &node_count) == 0 && node_count == 0.0 &&
+				GRBcbget(cbdata, where, GRB_CB_MIPNODE_OBJBND, &report->root_bound) == 0)
+				report->has_root_bound = true;
+		}
+		else if (where == GRB_CB_MIP) {
+			double primal = 0.0, dual = 0.0;
+			if (GRBcbget(cbdata, where, GRB_CB_MIP_OBJBST, &primal) == 0 &&
+				GRBcbget(cbdata, where, GRB_CB_MIP_OBJBND, &dual) == 0 &&
+				(runtime - data->last_sample >= 0.1 || primal != data->last_primal)) {
+				LinearProgramSolver::SolveReport::Sample sample = { runtime, primal, dual };
+				report->progress.push_back(sample);
+				data->last_sample = runtime;
+				data->last_primal = primal;
 			}
 		}
+		return 0;
+	}
+}
+
+
+bool LinearProgramSolver::_solve_GUROBI(const ColumnarProgram* program) {
+	if (!check_program(program))
+		return false;
+
+	static thread_local Environment environment;
+	GRBenv* env = environment.env;
+	if (!env)
+		return _solve_fallback(program, "Gurobi installed but license is missing or expired");
 
-		// Set objective
-		GRBLinExpr obj;
+	// create the model with its variables, the arrays are passed as they are
+	int num_variables = static_cast<int>(program->num_variables());
+	GRBmodel* model = 0;
+	int error = GRBnewmodel(env, &model, "", num_variables,
+		const_cast<double*>(program->objective().data()),
+		const_cast<double*>(program->lower_bounds().data()),
+		const_cast<double*>(program->upper_bounds().data()),
+		const_cast<char*>(program->types().data()), 0);
 
-		const LinearObjective* objective = program->objective();
-		const std::unordered_map<int, double>& obj_coeffs = objective->coefficients();
-		std::unordered_map<int, double>::const_iterator it = obj_coeffs.begin();
-		for (; it != obj_coeffs.end(); ++it) {
-            std::size_t var_idx = static_cast<std::size_t>(it->first);
-			double coeff = it->second;
-			obj += coeff * X[var_idx];
+	// Set objective function sense
+	bool minimize = (program->sense() == LinearObjective::MINIMIZE);
+	if (!error)
+		error = GRBsetintattr(model, GRB_INT_ATTR_MODELSENSE, minimize ? GRB_MINIMIZE : GRB_MAXIMIZE);
+
+	// Add constraints: the CSR matrix is passed as it is, ranged rows get a second row for the upper bound
+	int num_constraints = static_cast<int>(program->num_constraints());
+	const std::vector<double>& row_lower = program->row_lower_bounds();
+	const std::vector<double>& row_upper = program->row_upper_bounds();
+	std::vector<char> sense(num_constraints);
+	std::vector<double> rhs(num_constraints);
+	std::vector<int> ranged;
+	for (int i = 0; i < num_constraints; ++i) {
+		bool has_lower = row_lower[i] > -Variable::infinity();
+		bool has_upper = row_upper[i] < Variable::infinity();
+		if (has_lower && has_upper && row_lower[i] == row_upper[i]) {
+			sense[i] = GRB_EQUAL;
+			rhs[i] = row_lower[i];
 		}
-		// Set objective function sense
-		bool minimize = (objective->sense() == LinearObjective::MINIMIZE);
-		model.setObjective(obj, minimize ? GRB_MINIMIZE : GRB_MAXIMIZE);
-
-		// Optimize model
-        std::cout << "using the GUROBI solver (version " << GRB_VERSION_MAJOR << "." << GRB_VERSION_MINOR << ")." << std::endl;
-		model.optimize();
-
-        int status = model.get(GRB_IntAttr_Status);
-        switch (status) {
-		case GRB_OPTIMAL: {
-			objective_value_ = model.get(GRB_DoubleAttr_ObjVal);
-			result_.resize(variables.size());
-			for (std::size_t i = 0; i < variables.size(); ++i) {
-				result_[i] = X[i].get(GRB_DoubleAttr_X);
-			}
-			upload_solution(program);
-			break;
+		else if (has_lower) {
+			sense[i] = GRB_GREATER_EQUAL;
+			rhs[i] = row_lower[i];
+			if (has_upper)
+				ranged.push_back(i);
 		}
-		
+		else {
+			sense[i] = GRB_LESS_EQUAL;
+			rhs[i] = has_upper ? row_upper[i] : GRB_INFINITY;
+		}
+	}
+	if (!error && num_constraints > 0) {
+		error = GRBaddconstrs(model, num_constraints, static_cast<int>(program->num_nonzeros()),
+			const_cast<int*>(program->row_start().data()),
+			const_cast<int*>(program->columns().data()),
+			const_cast<double*>(program->values().data()),
+			sense.data(), rhs.data(), 0);
+	}
+	for (std::size_t k = 0; k < ranged.size() && !error; ++k) {
+		int i = ranged[k];
+		int start = program->row_start()[i];
+		error = GRBaddconstr(model, program->row_start()[i + 1] - start,
+			const_cast<int*>(program->columns().data() + start),
+			const_cast<double*>(program->values().data() + start),
+			GRB_LESS_EQUAL, row_upper[i], 0);
+	}
+
+	// lazy constraints are only enforced when violated by an incumbent
+	std::vector<int> lazy;
+	for (int i = 0; i < num_constraints; ++i) {
+		if (program->lazy()[i])
+			lazy.push_back(i);
+	}
+	for (std::size_t k = 0; k < ranged.size(); ++k) {
+		if (program->lazy()[ranged[k]])
+			lazy.push_back(num_constraints + static_cast<int>(k));
+	}
+	if (!error && !lazy.empty()) {
+		error = GRBupdatemodel(model);
+		std::vector<int> values(lazy.size(), 1);
+		if (!error)
+			error = GRBsetintattrlist(model, GRB_INT_ATTR_LAZY, static_cast<int>(lazy.size()), lazy.data(), values.data());
+	}
+
+	// Provide the initial incumbent
+	const std::vector<double>& start = program->mip_start();
+	if (!error && start.size() == program->num_variables())
+		error = GRBsetdblattrarray(model, GRB_DBL_ATTR_START, 0, num_variables, const_cast<double*>(start.data()));
+
+	// Budget
+	GRBenv* model_env = error ? 0 : GRBgetenv(model);
+	if (!error && budget_.time_limit >= 0.0)
+		error = GRBsetdblparam(model_env, GRB_DBL_PAR_TIMELIMIT, budget_.time_limit);
+	if (!error && budget_.node_limit >= 0)
+		error = GRBsetdblparam(model_env, GRB_DBL_PAR_NODELIMIT, static_cast<double>(budget_.node_limit));
+	if (!error && budget_.relative_gap >= 0.0)
+		error = GRBsetdblparam(model_env, GRB_DBL_PAR_MIPGAP, budget_.relative_gap);
+	if (!error)
+		error = GRBsetintparam(model_env, GRB_INT_PAR_THREADS, std::max(budget_.num_threads, 0));
+	if (!error && emphasis_ != BALANCED)
+		error = GRBsetintparam(model_env, GRB_INT_PAR_MIPFOCUS, (emphasis_ == FEASIBILITY) ? 1 : 2);
+	if (!error && emphasis_ == FEASIBILITY)
+		error = GRBsetdblparam(model_env, GRB_DBL_PAR_HEURISTICS, 0.5);
+	CallbackData callback_data = { cancel_, &report_, -1.0, GRB_INFINITY };
+	if (!error)
+		error = GRBsetcallbackfunc(model, callback, &callback_data);
+
+	// Optimize model
+	int status = 0;
+	if (!error) {
+		if (verbose_)
+			std::cout << "using the GUROBI solver (version " << GRB_VERSION_MAJOR << "." << GRB_VERSION_MINOR << ")." << std::endl;
+		error = GRBoptimize(model);
+	}
+	if (!error)
+		error = GRBgetintattr(model, GRB_INT_ATTR_STATUS, &status);
+
+	// the best incumbent is returned when a limit is reached
+	int num_solutions = 0;
+	if (!error)
+		error = GRBgetintattr(model, GRB_INT_ATTR_SOLCOUNT, &num_solutions);
+
+	if (error)
+		std::cerr << GRBgeterrormsg(env) << " (error code: " << error << ")." << std::endl;
+	else {
+		switch (status) {
+		case GRB_OPTIMAL:
+			status_ = OPTIMAL;
+			break;
+
+		case GRB_TIME_LIMIT:
+		case GRB_NODE_LIMIT:
+		case GRB_INTERRUPTED:
+			status_ = (num_solutions > 0) ? FEASIBLE : NO_SOLUTION;
+			std::cerr << "optimization was stopped by the budget with " << num_solutions << " solutions" << std::endl;
+			break;
+
 		case GRB_INF_OR_UNBD:
+			status_ = INFEASIBLE;
 			std::cerr << "model is infeasible or unbounded" << std::endl;
 			break;
 
 		case GRB_INFEASIBLE:
+			status_ = INFEASIBLE;
 			std::cerr << "model is infeasible" << std::endl;
 			break;
 
 		case GRB_UNBOUNDED:
+			status_ = INFEASIBLE;
 			std::cerr << "model is unbounded" << std::endl;
 			break;
 
@@ -163,19 +268,27 @@ bool LinearProgramSolver::_solve_GUROBI(const LinearProgram* program) {
 			break;
 		}
 
-		return (status == GRB_OPTIMAL);
-	}
-	catch (GRBException e) {
-        std::cerr << e.getMessage() << " (error code: " << e.getErrorCode() << ")." << std::endl;
-        if (e.getErrorCode() == GRB_ERROR_NO_LICENSE) {
-            std::cerr << "Gurobi installed but license is missing or expired. Please choose another solver, e.g., SCIP." << std::endl;
-        }
-	}
-	catch (...) {
-		std::cerr << "Exception during optimization" << std::endl;
+		if (status_ == OPTIMAL || status_ == FEASIBLE) {
+			result_.resize(num_variables);
+			error = GRBgetdblattr(model, GRB_DBL_ATTR_OBJVAL, &objective_value_);
+			if (!error)
+				error = GRBgetdblattrarray(model, GRB_DBL_ATTR_X, 0, num_variables, result_.data());
+			double node_count = 0.0;
+			if (!error && GRBgetdblattr(model, GRB_DBL_ATTR_NODECOUNT, &node_count) == 0)
+				report_.node_count = static_cast<long>(node_count);
+			if (!error && GRBgetdblattr(model, GRB_DBL_ATTR_MIPGAP, &gap_))
+				gap_ = -1.0;	// not available for continuous programs
+			if (!error)
+				round_solution(program);
+			else {
+				std::cerr << GRBgeterrormsg(env) << " (error code: " << error << ")." << std::endl;
+				status_ = FAILED;
+			}
+		}
 	}
 
-	return false;
+	GRBfreemodel(model);
+	return (status_ == OPTIMAL || status_ == FEASIBLE);
 }
 
 #endif
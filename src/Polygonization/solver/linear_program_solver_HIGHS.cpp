@@ -0,0 +1,169 @@
+/*
+Copyright (C) 2017  Liangliang Nan
+https://3d.bk.tudelft.nl/liangliang/ - liangliang.nan@gmail.com
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+
+#ifdef HAS_HIGHS
+
+#include "linear_program_solver.h"
+
+#include <Highs.h>
+
+#include <iostream>
+#include <algorithm>
+
+#if HIGHS_VERSION_MAJOR < 1 || (HIGHS_VERSION_MAJOR == 1 && HIGHS_VERSION_MINOR < 6)
+#error "HiGHS 1.6 or later is required (interrupt callbacks)"
+#endif
+
+
+namespace {
+
+	// The CSR arrays are passed as they are when HighsInt is an int (the default build of HiGHS)
+	const HighsInt* highs_indices(const std::vector<int>& indices, std::vector<HighsInt>* buffer) {
+		if (sizeof(HighsInt) == sizeof(int))
+			return reinterpret_cast<const HighsInt*>(indices.data());
+		buffer->assign(indices.begin(), indices.end());
+		return buffer->data();
+	}
+
+	// Bounds beyond Variable::infinity() are infinite
+	double highs_bound(double value) {
+		if (value >= Variable::infinity())
+			return kHighsInf;
+		if (value <= -Variable::infinity())
+			return -kHighsInf;
+		return value;
+	}
+
+}
+
+
+bool LinearProgramSolver::_solve_HIGHS(const ColumnarProgram* program) {
+	if (!check_program(program))
+		return false;
+
+	HighsInt num_variables = static_cast<HighsInt>(program->num_variables());
+	HighsInt num_constraints = static_cast<HighsInt>(program->num_constraints());
+
+	// Variable and row bounds, ranged rows are native
+	std::vector<double> lower(num_variables), upper(num_variables);
+	std::vector<HighsInt> integrality(num_variables);
+	for (HighsInt j = 0; j < num_variables; ++j) {
+		lower[j] = highs_bound(program->lower_bounds()[j]);
+		upper[j] = highs_bound(program->upper_bounds()[j]);
+		integrality[j] = static_cast<HighsInt>((program->types()[j] == ColumnarProgram::CONTINUOUS) ? HighsVarType::kContinuous : HighsVarType::kInteger);
+	}
+	std::vector<double> row_lower(num_constraints), row_upper(num_constraints);
+	for (HighsInt i = 0; i < num_constraints; ++i) {
+		row_lower[i] = highs_bound(program->row_lower_bounds()[i]);
+		row_upper[i] = highs_bound(program->row_upper_bounds()[i]);
+	}
+
+	// NOTE: HiGHS has no lazy constraints, they are all added to the model
+	Highs highs;
+	highs.setOptionValue("output_flag", false);
+
+	std::vector<HighsInt> start_buffer, index_buffer;
+	bool minimize = (program->sense() == LinearObjective::MINIMIZE);
+	HighsStatus status = highs.passModel(num_variables, num_constraints, static_cast<HighsInt>(program->num_nonzeros()),
+		static_cast<HighsInt>(MatrixFormat::kRowwise), static_cast<HighsInt>(minimize ? ObjSense::kMinimize : ObjSense::kMaximize), 0.0,
+		program->objective().data(), lower.data(), upper.data(), row_lower.data(), row_upper.data(),
+		highs_indices(program->row_start(), &start_buffer), highs_indices(program->columns(), &index_buffer), program->values().data(),
+		integrality.data());
+	if (status == HighsStatus::kError) {
+		std::cerr << "HiGHS could not load the model" << std::endl;
+		return false;
+	}
+
+	// Provide the initial incumbent
+	const std::vector<double>& start = program->mip_start();
+	if (start.size() == program->num_variables()) {
+		HighsSolution solution;
+		solution.col_value = start;
+		solution.value_valid = true;
+		highs.setSolution(solution);
+	}
+
+	// Budget
+	// NOTE: the thread pool of HiGHS is shared by the process and sized by the first solve.
+	if (budget_.time_limit >= 0.0)
+		highs.setOptionValue("time_limit", budget_.time_limit);
+	if (budget_.node_limit >= 0)
+		highs.setOptionValue("mip_max_nodes", static_cast<HighsInt>(budget_.node_limit));
+	if (budget_.relative_gap >= 0.0)
+		highs.setOptionValue("mip_rel_gap", budget_.relative_gap);
+	if (budget_.num_threads > 0)
+		highs.setOptionValue("threads", static_cast<HighsInt>(budget_.num_threads));
+
+	// The cancel flag is polled by the interrupt callbacks of the simplex, IPM and MIP solvers
+	// (the data types of the callback were renamed in HiGHS 1.10, hence the generic lambda)
+	if (cancel_) {
+		auto interrupt = [](int, const std::string&, const auto*, auto* data_in, void* user_data) {
+			if (data_in && static_cast<const std::atomic<bool>*>(user_data)->load())
+				data_in->user_interrupt = 1;
+		};
+		highs.setCallback(interrupt, const_cast<std::atomic<bool>*>(cancel_));
+		highs.startCallback(kCallbackSimplexInterrupt);
+		highs.startCallback(kCallbackIpmInterrupt);
+		highs.startCallback(kCallbackMipInterrupt);
+	}
+
+	if (verbose_)
+		std::cout << "using the HiGHS solver (version " << highs.version() << ")" << std::endl;
+	status = highs.run();
+	if (status == HighsStatus::kError) {
+		std::cerr << "HiGHS failed to solve the model" << std::endl;
+		return false;
+	}
+
+	// the best incumbent is returned when a limit is reached
+	const HighsInfo& info = highs.getInfo();
+	bool has_solution = (info.primal_solution_status == kSolutionStatusFeasible);
+	HighsModelStatus model_status = highs.getModelStatus();
+	switch (model_status) {
+	case HighsModelStatus::kOptimal:
+		status_ = has_solution ? OPTIMAL : FAILED;
+		break;
+
+	case HighsModelStatus::kInfeasible:
+	case HighsModelStatus::kUnbounded:
+	case HighsModelStatus::kUnboundedOrInfeasible:
+		status_ = INFEASIBLE;
+		std::cerr << "model is infeasible or unbounded" << std::endl;
+		break;
+
+	default:
+		status_ = has_solution ? FEASIBLE : NO_SOLUTION;
+		std::cerr << "optimization was stopped with status: " << highs.modelStatusToString(model_status) << std::endl;
+		break;
+	}
+	if (status_ != OPTIMAL && status_ != FEASIBLE)
+		return false;
+
+	result_ = highs.getSolution().col_value;
+	objective_value_ = info.objective_function_value;
+	report_.node_count = static_cast<long>(info.mip_node_count);
+	LinearProgramSolver::SolveReport::Sample sample = { highs.getRunTime(), objective_value_, info.mip_dual_bound };
+	report_.progress.push_back(sample);
+	gap_ = (info.mip_node_count >= 0) ? info.mip_gap : -1.0;	// not available for continuous programs
+	round_solution(program);
+	return true;
+}
+
+#endif
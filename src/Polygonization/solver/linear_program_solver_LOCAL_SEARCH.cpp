@@ -0,0 +1,274 @@
+/*
+Copyright (C) 2017  Liangliang Nan
+https://3d.bk.tudelft.nl/liangliang/ - liangliang.nan@gmail.com
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+
+#include "linear_program_solver.h"
+#include "fan_program.h"
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <thread>
+
+
+namespace {
+
+	// Result of a search thread
+	struct SearchResult {
+		std::vector<char> selected;
+		double			  value;
+	};
+
+
+	// Sum of the costs of the selected faces
+	double selection_cost(const FanProgram& program, const std::vector<char>& selected) {
+		double value = 0.0;
+		const std::vector<double>& costs = program.costs();
+		for (std::size_t f = 0; f < costs.size(); ++f) {
+			if (selected[f])
+				value += costs[f];
+		}
+		return value;
+	}
+
+
+	// Large neighborhood search: a random region around a face is unselected (destroy), then the
+	// region is grown again from randomly perturbed costs (repair). Worse selections are accepted
+	// with a probability decreasing over time (simulated annealing). Every visited selection is feasible.
+	void search(const FanProgram* program, const std::vector<char>* start, double time_limit, const std::atomic<bool>* cancel,
+		        unsigned int seed, SearchResult* result) {
+		typedef std::chrono::steady_clock Clock;
+		Clock::time_point t0 = Clock::now();
+
+		const std::vector<double>& costs = program->costs();
+		const std::vector< std::vector<std::size_t> >& fans = program->fans();
+		const std::vector< std::vector<std::size_t> >& face_fans = program->face_fans();
+		std::size_t num_faces = program->num_faces();
+
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+		// Current selection
+		std::vector<char> selected = *start;
+		std::vector<int> count(program->num_fans(), 0);
+		for (std::size_t k = 0; k < fans.size(); ++k) {
+			for (std::size_t j = 0; j < fans[k].size(); ++j)
+				count[k] += selected[fans[k][j]] ? 1 : 0;
+		}
+		double value = selection_cost(*program, selected);
+
+		result->selected = selected;
+		result->value = value;
+
+		// Temperature scale: mean magnitude of the costs
+		double scale = 0.0;
+		for (std::size_t f = 0; f < num_faces; ++f)
+			scale += std::abs(costs[f]);
+		scale = (num_faces > 0) ? 0.1 * scale / num_faces : 0.0;
+
+		std::size_t max_region = std::max<std::size_t>(2, std::min<std::size_t>(num_faces / 2, 64));
+		std::size_t max_stall = std::max<std::size_t>(2000, 20 * num_faces);
+
+		std::vector<double> perturbed(costs);
+		std::vector<char> in_region(num_faces, 0);
+		std::vector<char> touched(num_faces, 0);
+		std::vector<std::size_t> region, changed, open, seeds;
+
+		std::size_t stall = 0;
+		while (stall < max_stall) {
+			double elapsed = std::chrono::duration<double>(Clock::now() - t0).count();
+			if (elapsed > time_limit || (cancel && cancel->load()))
+				break;
+
+			std::vector<char> backup_selected = selected;
+			std::vector<int> backup_count = count;
+
+			// Destroy: a region grown from a random face through the fans
+			std::size_t region_size = 1 + rng() % max_region;
+			region.clear();
+			region.push_back(rng() % num_faces);
+			in_region[region[0]] = 1;
+			for (std::size_t i = 0; i < region.size() && region.size() < region_size; ++i) {
+				std::size_t f = region[i];
+				for (std::size_t l = 0; l < face_fans[f].size() && region.size() < region_size; ++l) {
+					const std::vector<std::size_t>& fan = fans[face_fans[f][l]];
+					for (std::size_t j = 0; j < fan.size() && region.size() < region_size; ++j) {
+						if (in_region[fan[j]])
+							continue;
+						in_region[fan[j]] = 1;
+						region.push_back(fan[j]);
+					}
+				}
+			}
+
+			changed.clear();
+			for (std::size_t i = 0; i < region.size(); ++i) {
+				if (selected[region[i]])
+					changed.push_back(region[i]);
+			}
+			program->remove_faces(region, &selected, &count);
+
+			// Repair: perturb the costs of the region
+			for (std::size_t i = 0; i < region.size(); ++i) {
+				std::size_t f = region[i];
+				perturbed[f] = costs[f] + scale * (2.0 * uniform(rng) - 1.0);
+			}
+
+			// Close the boundary of the removed region, or remove the remaining patch
+			open.clear();
+			for (std::size_t i = 0; i < region.size(); ++i) {
+				std::size_t f = region[i];
+				for (std::size_t l = 0; l < face_fans[f].size(); ++l) {
+					if (count[face_fans[f][l]] == 1)
+						open.push_back(face_fans[f][l]);
+				}
+			}
+			bool closed = false;
+			if (uniform(rng) < 0.5)
+				closed = program->close_fans(&open, perturbed, &selected, &count, &changed);
+			if (!closed) {
+				open.clear();
+				for (std::size_t i = 0; i < changed.size(); ++i) {
+					std::size_t f = changed[i];
+					open.insert(open.end(), face_fans[f].begin(), face_fans[f].end());
+				}
+				program->drop_open_fans(&open, &selected, &count, &changed);
+			}
+
+			// Grow closed patches from the promising faces of the region
+			seeds.clear();
+			for (std::size_t i = 0; i < region.size(); ++i) {
+				if (perturbed[region[i]] < 0.0)
+					seeds.push_back(region[i]);
+			}
+			std::sort(seeds.begin(), seeds.end(), [&perturbed](std::size_t a, std::size_t b) { return perturbed[a] < perturbed[b]; });
+
+			std::vector<std::size_t> added;
+			for (std::size_t i = 0; i < seeds.size(); ++i) {
+				if (selected[seeds[i]])
+					continue;
+
+				added.clear();
+				bool closed = program->close_patch(seeds[i], perturbed, &selected, &count, &added);
+				double delta = 0.0;
+				for (std::size_t j = 0; j < added.size(); ++j)
+					delta += perturbed[added[j]];
+
+				if (!closed || delta >= 0.0)
+					program->remove_faces(added, &selected, &count);
+				else
+					changed.insert(changed.end(), added.begin(), added.end());
+			}
+
+			// Objective change
+			double delta = 0.0;
+			for (std::size_t i = 0; i < changed.size(); ++i) {
+				std::size_t f = changed[i];
+				if (touched[f])
+					continue;
+				touched[f] = 1;
+				if (selected[f] != backup_selected[f])
+					delta += selected[f] ? costs[f] : -costs[f];
+			}
+			for (std::size_t i = 0; i < changed.size(); ++i)
+				touched[changed[i]] = 0;
+
+			for (std::size_t i = 0; i < region.size(); ++i) {
+				in_region[region[i]] = 0;
+				perturbed[region[i]] = costs[region[i]];
+			}
+
+			// Acceptance
+			double temperature = scale * std::max(0.0, 1.0 - elapsed / time_limit);
+			bool accept = (delta <= 0.0) || (temperature > 0.0 && uniform(rng) < std::exp(-delta / temperature));
+			if (accept)
+				value += delta;
+			else {
+				selected.swap(backup_selected);
+				count.swap(backup_count);
+			}
+
+			if (value < result->value - 1e-12) {
+				result->selected = selected;
+				result->value = value;
+				stall = 0;
+			}
+			else
+				++stall;
+		}
+	}
+
+}
+
+
+bool LinearProgramSolver::_solve_LOCAL_SEARCH(const ColumnarProgram* program) {
+	if (!check_program(program))
+		return false;
+
+	// lazy constraints are handled as regular ones: every visited selection satisfies all the fans
+	FanProgram fan_program;
+	if (!fan_program.extract(program)) {
+		std::cerr << "the local search solver only handles face selection programs (binary variables and edge constraints)" << std::endl;
+		return false;
+	}
+
+	// Initial selection: the provided start, or a greedy one
+	std::vector<char> start;
+	const std::vector<double>& mip_start = program->mip_start();
+	if (mip_start.size() == program->num_variables())
+		start = fan_program.to_selection(mip_start);
+	if (start.empty() || !fan_program.is_feasible(start))
+		start = fan_program.greedy_selection();
+
+	// Independent searches with different seeds
+	std::vector<SearchResult> results(1);
+	results[0].selected = start;
+	results[0].value = selection_cost(fan_program, start);
+
+	if (fan_program.num_faces() > 0 && fan_program.num_fans() > 0) {
+		// the search is time bounded: 10 seconds unless specified by the budget (the node limit does not apply)
+		double time_limit = (budget_.time_limit >= 0.0) ? budget_.time_limit : 10.0;
+		std::size_t num_threads = (budget_.num_threads > 0) ? budget_.num_threads : std::max(1u, std::thread::hardware_concurrency());
+		num_threads = std::min(num_threads, 1 + fan_program.num_faces() / 64);
+
+		results.resize(num_threads);
+		std::vector<std::thread> threads;
+		for (std::size_t t = 1; t < num_threads; ++t)
+			threads.push_back(std::thread(search, &fan_program, &start, time_limit, cancel_, static_cast<unsigned int>(t), &results[t]));
+		search(&fan_program, &start, time_limit, cancel_, 0u, &results[0]);
+		for (std::size_t t = 0; t < threads.size(); ++t)
+			threads[t].join();
+	}
+
+	std::size_t best = 0;
+	for (std::size_t t = 1; t < results.size(); ++t) {
+		if (results[t].value < results[best].value)
+			best = t;
+	}
+
+	result_ = fan_program.to_solution(results[best].selected);
+	objective_value_ = fan_program.objective_value(results[best].selected);
+	round_solution(program);
+
+	// no bound is known
+	status_ = FEASIBLE;
+	return true;
+}
@@ -0,0 +1,166 @@
+/*
+Copyright (C) 2017  Liangliang Nan
+https://3d.bk.tudelft.nl/liangliang/ - liangliang.nan@gmail.com
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+
+#include "linear_program_solver.h"
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+
+namespace {
+
+	const char* solver_name(LinearProgramSolver::SolverName solver) {
+		switch (solver) {
+		case LinearProgramSolver::GUROBI:		return "Gurobi";
+		case LinearProgramSolver::SCIP:			return "SCIP";
+		case LinearProgramSolver::LOCAL_SEARCH:	return "local search";
+		case LinearProgramSolver::SOPLEX:		return "SoPlex";
+		case LinearProgramSolver::HIGHS:		return "HiGHS";
+		default:								return "portfolio";
+		}
+	}
+
+}
+
+
+bool LinearProgramSolver::is_cancellable(SolverName solver) {
+	switch (solver) {
+	case GUROBI:		return true;	// callback
+	case SCIP:			return true;	// not built, runs the local search
+	case LOCAL_SEARCH:	return true;	// between iterations
+	case SOPLEX:		return false;	// spx.optimize() cannot be interrupted
+	case HIGHS:			return true;	// interrupt callbacks
+	default:			return false;
+	}
+}
+
+
+// Only members that can be cancelled, so that the first optimal one ends the portfolio
+std::vector<LinearProgramSolver::PortfolioEntry> LinearProgramSolver::default_portfolio() {
+	std::vector<PortfolioEntry> entries;
+#ifdef HAS_GUROBI
+	PortfolioEntry gurobi_default = { GUROBI, BALANCED };
+	PortfolioEntry gurobi_heuristics = { GUROBI, FEASIBILITY };
+	entries.push_back(gurobi_default);
+	entries.push_back(gurobi_heuristics);
+#endif
+#ifdef HAS_HIGHS
+	PortfolioEntry highs = { HIGHS, BALANCED };
+	entries.push_back(highs);
+#endif
+	PortfolioEntry local_search = { LOCAL_SEARCH, BALANCED };
+	entries.push_back(local_search);
+	return entries;
+}
+
+
+bool LinearProgramSolver::_solve_PORTFOLIO(const ColumnarProgram* program) {
+	if (!check_program(program))
+		return false;
+
+	std::vector<PortfolioEntry> entries;
+	std::vector<PortfolioEntry> requested = portfolio_.empty() ? default_portfolio() : portfolio_;
+	for (std::size_t i = 0; i < requested.size(); ++i) {
+		if (requested[i].solver == PORTFOLIO)
+			continue;
+		if (budget_.time_limit < 0.0 && !is_cancellable(requested[i].solver)) {
+			std::cerr << "WARNING: " << solver_name(requested[i].solver) << " cannot be cancelled, it is left out of the portfolio (no time limit)" << std::endl;
+			continue;
+		}
+		entries.push_back(requested[i]);
+	}
+	if (entries.empty()) {
+		std::cerr << "the portfolio is empty" << std::endl;
+		return false;
+	}
+
+	// the members share the time limit and split the threads
+	std::size_t num_members = entries.size();
+	int num_threads = (budget_.num_threads > 0) ? budget_.num_threads : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+	Budget member_budget = budget_;
+	member_budget.num_threads = std::max(1, num_threads / static_cast<int>(num_members));
+
+	// each member solves the same (read-only) program, the first optimal one cancels the others
+	std::atomic<bool> cancel(false);
+	std::atomic<int> winner(-1);
+	std::atomic<std::size_t> num_done(0);
+	std::vector<LinearProgramSolver> members(num_members);
+	std::vector<std::thread> threads;
+	for (std::size_t i = 0; i < num_members; ++i) {
+		members[i].set_budget(member_budget);
+		members[i].set_emphasis(entries[i].emphasis);
+		members[i].set_cancel_flag(&cancel);
+		members[i].set_verbose(verbose_);
+		threads.push_back(std::thread([&, i]() {
+			if (members[i].solve(program, entries[i].solver) && members[i].status() == OPTIMAL) {
+				int none = -1;
+				if (winner.compare_exchange_strong(none, static_cast<int>(i)))
+					cancel = true;
+			}
+			++num_done;
+		}));
+	}
+
+	// forward an external cancellation
+	while (num_done < num_members) {
+		if (cancel_ && cancel_->load())
+			cancel = true;
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	for (std::size_t i = 0; i < threads.size(); ++i)
+		threads[i].join();
+
+	// the first optimal result, or the best incumbent
+	int best = winner;
+	bool minimize = (program->sense() == LinearObjective::MINIMIZE);
+	for (std::size_t i = 0; winner < 0 && i < num_members; ++i) {
+		if (members[i].status() != FEASIBLE)
+			continue;
+		double value = members[i].objective_value();
+		if (best < 0 || (minimize && value < members[best].objective_value()) || (!minimize && value > members[best].objective_value()))
+			best = static_cast<int>(i);
+	}
+
+	if (best < 0) {
+		status_ = NO_SOLUTION;
+		for (std::size_t i = 0; i < num_members; ++i) {
+			if (members[i].status() == INFEASIBLE)
+				status_ = INFEASIBLE;
+		}
+		std::cerr << "no member of the portfolio found a solution" << std::endl;
+		return false;
+	}
+
+	const LinearProgramSolver& chosen = members[best];
+	if (verbose_) {
+		std::cout << "portfolio: " << solver_name(entries[best].solver) << (entries[best].emphasis == FEASIBILITY ? " (feasibility)" : entries[best].emphasis == OPTIMALITY ? " (optimality)" : "")
+			<< " kept out of " << num_members << " members" << (winner >= 0 ? " (optimal)" : " (best incumbent)") << std::endl;
+	}
+
+	status_ = chosen.status();
+	result_ = chosen.solution();
+	objective_value_ = chosen.objective_value();
+	relaxation_bound_ = chosen.relaxation_bound();
+	gap_ = chosen.gap();
+	report_ = chosen.report();
+	return true;
+}
@@ -0,0 +1,229 @@
+/*
+Copyright (C) 2017  Liangliang Nan
+https://3d.bk.tudelft.nl/liangliang/ - liangliang.nan@gmail.com
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+
+#include "linear_program_solver.h"
+
+
+#ifdef HAS_SOPLEX
+
+#include "fan_program.h"
+
+#include "soplex.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+
+
+namespace {
+
+	// Converts an infinite bound
+	double soplex_bound(double value) {
+		if (value <= -Variable::infinity())
+			return -soplex::infinity;
+		if (value >= Variable::infinity())
+			return soplex::infinity;
+		return value;
+	}
+
+
+	// Adds constraint i of a program to a row set
+	void add_row(const ColumnarProgram* program, std::size_t i, soplex::LPRowSetReal* rows) {
+		int start = program->row_start()[i];
+		int n = program->row_start()[i + 1] - start;
+		soplex::DSVectorReal row(n);
+		row.add(n, program->columns().data() + start, program->values().data() + start);
+		rows->add(soplex_bound(program->row_lower_bounds()[i]), row, soplex_bound(program->row_upper_bounds()[i]));
+	}
+
+}
+
+
+bool LinearProgramSolver::_solve_SOPLEX(const ColumnarProgram* program) {
+	try {
+		if (!check_program(program))
+			return false;
+
+		soplex::SoPlex spx;
+		spx.setIntParam(soplex::SoPlex::VERBOSITY, soplex::SoPlex::VERBOSITY_ERROR);
+
+		// create variables (integrality is relaxed)
+		std::size_t num_variables = program->num_variables();
+		const std::vector<double>& lower = program->lower_bounds();
+		const std::vector<double>& upper = program->upper_bounds();
+		const std::vector<double>& objective = program->objective();
+
+		soplex::LPColSetReal cols(static_cast<int>(num_variables));
+		soplex::DSVectorReal dummy(0);
+		for (std::size_t i = 0; i < num_variables; ++i)
+			cols.add(objective[i], soplex_bound(lower[i]), dummy, soplex_bound(upper[i]));
+		spx.addColsReal(cols);
+
+		// Set objective function sense
+		bool minimize = (program->sense() == LinearObjective::MINIMIZE);
+		spx.setIntParam(soplex::SoPlex::OBJSENSE, minimize ? soplex::SoPlex::OBJSENSE_MINIMIZE : soplex::SoPlex::OBJSENSE_MAXIMIZE);
+
+		// Add constraints, lazy constraints are added once violated
+		std::vector<std::size_t> pending;
+		soplex::LPRowSetReal rows(static_cast<int>(program->num_constraints()), static_cast<int>(program->num_nonzeros()));
+		for (std::size_t i = 0; i < program->num_constraints(); ++i) {
+			if (program->lazy()[i])
+				pending.push_back(i);
+			else
+				add_row(program, i, &rows);
+		}
+		spx.addRowsReal(rows);
+
+		// Solve the relaxation, the model is reused (warm started) after adding violated constraints
+		if (verbose_)
+			std::cout << "using the SoPlex solver (version " << SOPLEX_VERSION << ") with rounding." << std::endl;
+		soplex::DVectorReal primal(static_cast<int>(num_variables));
+		std::size_t num_lazy = pending.size();
+		std::size_t num_rounds = 0;
+		typedef std::chrono::steady_clock Clock;
+		Clock::time_point t0 = Clock::now();
+		while (true) {
+			// the time limit is shared by all the rounds (SoPlex is single threaded, the node limit does not apply)
+			if (budget_.time_limit >= 0.0) {
+				double elapsed = std::chrono::duration<double>(Clock::now() - t0).count();
+				spx.setRealParam(soplex::SoPlex::TIMELIMIT, std::max(0.0, budget_.time_limit - elapsed));
+			}
+
+			soplex::SPxSolver::Status status = spx.optimize();
+			if (status != soplex::SPxSolver::OPTIMAL) {
+				if (status == soplex::SPxSolver::ABORT_TIME)
+					status_ = NO_SOLUTION;
+				else if (status == soplex::SPxSolver::INFEASIBLE || status == soplex::SPxSolver::UNBOUNDED || status == soplex::SPxSolver::INForUNBD)
+					status_ = INFEASIBLE;
+				std::cerr << "LP relaxation was not solved to optimality (status = " << status << ")" << std::endl;
+				return false;
+			}
+			spx.getPrimalReal(primal);
+
+			// the remaining violated rows are handled by the repair when cancelled
+			if (cancel_ && cancel_->load())
+				break;
+
+			rows.clear();
+			std::vector<std::size_t> remaining;
+			for (std::size_t i = 0; i < pending.size(); ++i) {
+				if (program->is_violated(pending[i], primal.get_const_ptr()))
+					add_row(program, pending[i], &rows);
+				else
+					remaining.push_back(pending[i]);
+			}
+			if (rows.num() == 0)
+				break;
+
+			spx.addRowsReal(rows);
+			pending.swap(remaining);
+			++num_rounds;
+		}
+		if (num_lazy > 0 && verbose_) {
+			std::cout << "Lazy constraints: " << num_lazy - pending.size() << " of " << num_lazy
+				<< " added in " << num_rounds << " rounds" << std::endl;
+		}
+
+		double bound = spx.objValueReal();
+
+		std::vector<double> relaxed(num_variables);
+		bool integral = true;
+		for (std::size_t i = 0; i < num_variables; ++i) {
+			relaxed[i] = primal[static_cast<int>(i)];
+			if (program->types()[i] != ColumnarProgram::CONTINUOUS && std::abs(relaxed[i] - std::round(relaxed[i])) > 1e-6)
+				integral = false;
+		}
+		for (std::size_t i = 0; integral && i < pending.size(); ++i) {
+			if (program->is_violated(pending[i], relaxed.data()))
+				integral = false;	// cancelled before all the lazy rows were added
+		}
+
+		if (integral) {
+			result_ = relaxed;
+			objective_value_ = bound;
+		}
+		else {
+			// Round and repair the face selection
+			FanProgram fan_program;
+			if (!fan_program.extract(program)) {
+				std::cerr << "fractional LP solution and the program is not a face selection program" << std::endl;
+				return false;
+			}
+
+			// faces are ranked by their fractional value first, then by their cost
+			const std::vector<double>& costs = fan_program.costs();
+			double scale = 0.0;
+			for (std::size_t f = 0; f < costs.size(); ++f)
+				scale = std::max(scale, std::abs(costs[f]));
+			scale = 2.0 * scale + 1.0;
+
+			std::vector<char> selected = fan_program.to_selection(relaxed);
+			std::vector<double> ranking(costs);
+			for (std::size_t f = 0; f < costs.size(); ++f)
+				ranking[f] -= scale * fan_program.face_value(relaxed, f);
+			fan_program.repair(&selected, ranking);
+
+			// greedy patches guided by the relaxation, and the plain greedy selection
+			std::vector<char> candidates[2] = { fan_program.greedy_selection(ranking), fan_program.greedy_selection() };
+			double value = fan_program.objective_value(selected);
+			for (std::size_t i = 0; i < 2; ++i) {
+				double candidate_value = fan_program.objective_value(candidates[i]);
+				if ((minimize && candidate_value < value) || (!minimize && candidate_value > value)) {
+					selected.swap(candidates[i]);
+					value = candidate_value;
+				}
+			}
+
+			result_ = fan_program.to_solution(selected);
+			objective_value_ = value;
+		}
+
+		relaxation_bound_ = bound;
+		double gap = std::abs(objective_value_ - bound) / std::max(std::abs(objective_value_), 1e-10);
+		if (verbose_) {
+			std::cout << "LP relaxation bound: " << bound << ", rounded objective: " << objective_value_
+				<< ", integrality gap: " << 100.0 * gap << "%" << std::endl;
+		}
+
+		round_solution(program);
+		gap_ = gap;
+
+		// the relaxation is the root, no branching
+		double time = std::chrono::duration<double>(Clock::now() - t0).count();
+		LinearProgramSolver::SolveReport::Sample sample = { time, objective_value_, bound };
+		report_.progress.push_back(sample);
+		report_.root_bound = bound;
+		report_.has_root_bound = true;
+		report_.node_count = 0;
+		status_ = (gap <= budget_.relative_gap) ? OPTIMAL : FEASIBLE;
+		return true;
+	}
+	catch (const soplex::SPxException& e) {
+		std::cerr << e.what() << std::endl;
+	}
+	catch (...) {
+		std::cerr << "Exception during optimization" << std::endl;
+	}
+
+	return false;
+}
+
+#endif
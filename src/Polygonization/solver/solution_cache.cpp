@@ -0,0 +1,227 @@
+/*
+Copyright (C) 2017  Liangliang Nan
+https://3d.bk.tudelft.nl/liangliang/ - liangliang.nan@gmail.com
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+
+#include "solution_cache.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <thread>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace {
+
+	const char			magic[4] = { 'P', 'S', 'O', 'L' };
+	const std::uint32_t version = 1;
+
+	const std::uint64_t fnv_offset = 14695981039346656037ull;
+	const std::uint64_t fnv_prime = 1099511628211ull;
+
+	void fnv_bytes(std::uint64_t* h, const void* data, std::size_t size) {
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (std::size_t i = 0; i < size; ++i) {
+			*h ^= bytes[i];
+			*h *= fnv_prime;
+		}
+	}
+
+	void fnv_integer(std::uint64_t* h, std::int64_t value) { fnv_bytes(h, &value, sizeof(value)); }
+
+	// Quantized value, infinite bounds are mapped to the extreme integers.
+	// Values too large to be quantized (and NaN) are hashed by their bits.
+	std::int64_t quantize(double value, double tolerance) {
+		if (value >= Variable::infinity())
+			return INT64_MAX;
+		if (value <= -Variable::infinity())
+			return INT64_MIN;
+		double scaled = value / tolerance;
+		if (!(std::abs(scaled) < 9.2e18)) {
+			std::int64_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			return bits;
+		}
+		return static_cast<std::int64_t>(std::llround(scaled));
+	}
+
+	int process_id() {
+#ifdef _WIN32
+		return _getpid();
+#else
+		return static_cast<int>(getpid());
+#endif
+	}
+
+	bool make_directory(const std::string& directory) {
+#ifdef _WIN32
+		return _mkdir(directory.c_str()) == 0 || errno == EEXIST;
+#else
+		return mkdir(directory.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+	}
+
+}
+
+
+SolutionCache::SolutionCache(const std::string& directory, double tolerance)
+	: directory_(directory)
+	, tolerance_(tolerance)
+	, num_hits_(0)
+	, num_misses_(0)
+{
+	if (!make_directory(directory_))
+		std::cerr << "could not create the solution cache directory \'" << directory_ << "\'" << std::endl;
+}
+
+
+std::uint64_t SolutionCache::hash(const ColumnarProgram* program) const {
+	std::uint64_t h = fnv_offset;
+
+	// Variables, in order (the solution is indexed by them)
+	std::size_t num_variables = program->num_variables();
+	fnv_integer(&h, static_cast<std::int64_t>(num_variables));
+	fnv_integer(&h, program->sense());
+	for (std::size_t j = 0; j < num_variables; ++j) {
+		fnv_integer(&h, program->types()[j]);
+		fnv_integer(&h, quantize(program->lower_bounds()[j], tolerance_));
+		fnv_integer(&h, quantize(program->upper_bounds()[j], tolerance_));
+		fnv_integer(&h, quantize(program->objective()[j], tolerance_));
+	}
+
+	// Constraints: entries sorted by variable, then the constraint hashes are sorted
+	std::size_t num_constraints = program->num_constraints();
+	const std::vector<int>& row_start = program->row_start();
+	std::vector<std::uint64_t> rows(num_constraints);
+	std::vector< std::pair<int, std::int64_t> > entries;
+	for (std::size_t i = 0; i < num_constraints; ++i) {
+		entries.clear();
+		for (int k = row_start[i]; k < row_start[i + 1]; ++k)
+			entries.push_back(std::make_pair(program->columns()[k], quantize(program->values()[k], tolerance_)));
+		std::sort(entries.begin(), entries.end());
+
+		std::uint64_t r = fnv_offset;
+		fnv_integer(&r, quantize(program->row_lower_bounds()[i], tolerance_));
+		fnv_integer(&r, quantize(program->row_upper_bounds()[i], tolerance_));
+		for (std::size_t k = 0; k < entries.size(); ++k) {
+			fnv_integer(&r, entries[k].first);
+			fnv_integer(&r, entries[k].second);
+		}
+		rows[i] = r;
+	}
+	std::sort(rows.begin(), rows.end());
+
+	fnv_integer(&h, static_cast<std::int64_t>(num_constraints));
+	fnv_bytes(&h, rows.data(), rows.size() * sizeof(std::uint64_t));
+	return h;
+}
+
+
+std::string SolutionCache::file_name(std::uint64_t key) const {
+	std::ostringstream name;
+	name << directory_ << "/" << std::hex << std::setw(16) << std::setfill('0') << key << ".sol";
+	return name.str();
+}
+
+
+bool SolutionCache::lookup(const ColumnarProgram* program, std::vector<double>* solution, double* objective_value) {
+	std::ifstream in(file_name(hash(program)).c_str(), std::ios::binary);
+	std::size_t num_variables = program->num_variables();
+
+	char file_magic[4] = { 0, 0, 0, 0 };
+	std::uint32_t file_version = 0;
+	std::uint64_t file_num_variables = 0;
+	double value = 0.0;
+	if (in) {
+		in.read(file_magic, sizeof(file_magic));
+		in.read(reinterpret_cast<char*>(&file_version), sizeof(file_version));
+		in.read(reinterpret_cast<char*>(&file_num_variables), sizeof(file_num_variables));
+		in.read(reinterpret_cast<char*>(&value), sizeof(value));
+	}
+	if (!in || std::memcmp(file_magic, magic, sizeof(magic)) != 0 || file_version != version || file_num_variables != num_variables) {
+		++num_misses_;
+		return false;
+	}
+
+	std::vector<double> values(num_variables);
+	in.read(reinterpret_cast<char*>(values.data()), num_variables * sizeof(double));
+
+	// Guards against collisions and changed tolerances
+	bool valid = static_cast<bool>(in);
+	for (std::size_t i = 0; valid && i < program->num_constraints(); ++i) {
+		if (program->is_violated(i, values.data()))
+			valid = false;
+	}
+	if (!valid) {
+		++num_misses_;
+		return false;
+	}
+
+	solution->swap(values);
+	*objective_value = value;
+	++num_hits_;
+	return true;
+}
+
+
+bool SolutionCache::store(const ColumnarProgram* program, const std::vector<double>& solution, double objective_value) {
+	if (solution.size() != program->num_variables())
+		return false;
+
+	// Written to a temporary file first (unique to the process and thread), then renamed
+	std::string name = file_name(hash(program));
+	std::ostringstream temporary;
+	temporary << name << "." << process_id() << "." << std::this_thread::get_id() << ".tmp";
+	{
+		std::ofstream out(temporary.str().c_str(), std::ios::binary);
+		std::uint64_t num_variables = solution.size();
+		out.write(magic, sizeof(magic));
+		out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+		out.write(reinterpret_cast<const char*>(&num_variables), sizeof(num_variables));
+		out.write(reinterpret_cast<const char*>(&objective_value), sizeof(objective_value));
+		out.write(reinterpret_cast<const char*>(solution.data()), solution.size() * sizeof(double));
+		if (!out) {
+			std::cerr << "could not write the solution cache file \'" << temporary.str() << "\'" << std::endl;
+			std::remove(temporary.str().c_str());
+			return false;
+		}
+	}
+
+#ifdef _WIN32
+	std::remove(name.c_str());	// rename() does not replace an existing file on Windows
+#endif
+	if (std::rename(temporary.str().c_str(), name.c_str()) != 0) {
+		std::remove(temporary.str().c_str());
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,69 @@
+/*
+Copyright (C) 2017  Liangliang Nan
+https://3d.bk.tudelft.nl/liangliang/ - liangliang.nan@gmail.com
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+
+#ifndef _MATH_SOLUTION_CACHE_H_
+#define _MATH_SOLUTION_CACHE_H_
+
+#include "columnar_program.h"
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+
+// An on-disk store of optimal solutions, addressed by a canonical hash of the program:
+// the bounds, types and objective coefficients of the variables, and the constraints with
+// their entries sorted by variable (the order of the constraints does not matter). All the
+// values are quantized to a tolerance (those too large for it are hashed exactly). A hit is
+// checked against the constraints before use. Each solution is a file <directory>/<hash>.sol,
+// written atomically, so that several processes and threads can share a directory.
+class SolutionCache
+{
+public:
+	SolutionCache(const std::string& directory, double tolerance = 1e-9);
+	~SolutionCache() {}
+
+	const std::string& directory() const { return directory_; }
+
+	// Canonical 64-bit (FNV-1a) hash of the program.
+	std::uint64_t hash(const ColumnarProgram* program) const;
+
+	// Retrieves the solution of the program, returns false if not stored.
+	bool lookup(const ColumnarProgram* program, std::vector<double>* solution, double* objective_value);
+
+	// Stores the (optimal) solution of the program.
+	bool store(const ColumnarProgram* program, const std::vector<double>& solution, double objective_value);
+
+	std::size_t num_hits() const { return num_hits_; }
+	std::size_t num_misses() const { return num_misses_; }
+
+private:
+	std::string file_name(std::uint64_t key) const;
+
+private:
+	std::string	directory_;
+	double		tolerance_;
+
+	std::atomic<std::size_t> num_hits_;
+	std::atomic<std::size_t> num_misses_;
+};
+
+#endif